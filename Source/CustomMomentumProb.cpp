@@ -7,7 +7,7 @@ using namespace amrex;
 ///
 /// This "custom" momentum distribution just does 0 momentum
 ///
-void CustomMomentumDistribution::getMomentum(vec3& u, Real x, Real y, Real z) {
+void CustomMomentumDistribution::getMomentum(vec3& u, Real x, Real y, Real z, std::uint64_t key) {
   u[0] = 0;
   u[1] = 0;
   u[2] = 0;
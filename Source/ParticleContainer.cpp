@@ -10,6 +10,35 @@ using namespace amrex;
 
 constexpr int MultiParticleContainer::nstencilz_fdtd_nci_corr;
 
+namespace
+{
+    // Apply the Godfrey (NCI corrector) stencil along z to a field component,
+    // over the guard cells that are used by the field gather.
+    std::unique_ptr<MultiFab>
+    GodfreyFilter (const MultiFab& src, const Real* stencil, int nstencil)
+    {
+#if (AMREX_SPACEDIM == 2)
+        const IntVect ng(static_cast<int>(WarpX::nox), static_cast<int>(WarpX::noz));
+#else
+        const IntVect ng(static_cast<int>(WarpX::nox), static_cast<int>(WarpX::noy),
+                         static_cast<int>(WarpX::noz));
+#endif
+        std::unique_ptr<MultiFab> dst(new MultiFab(src.boxArray(), src.DistributionMap(), 1, ng));
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(*dst,true); mfi.isValid(); ++mfi)
+        {
+            const Box& tbx = mfi.growntilebox();
+            WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(tbx),
+                                    BL_TO_FORTRAN_ANYD((*dst)[mfi]),
+                                    BL_TO_FORTRAN_ANYD(src[mfi]),
+                                    stencil, &nstencil);
+        }
+        return dst;
+    }
+}
+
 MultiParticleContainer::MultiParticleContainer (AmrCore* amr_core)
 {
     ReadParameters();
@@ -221,6 +250,50 @@ MultiParticleContainer::Evolve (int lev,
     if (cjz) cjz->setVal(0.0);
     if (rho) rho->setVal(0.0);
     if (crho) crho->setVal(0.0);
+
+    if (WarpX::use_fdtd_nci_corr)
+    {
+        // The fields seen by the particles are filtered once per level,
+        // and shared by all the species.
+        std::array<std::unique_ptr<MultiFab>,3> fE, fB, fcE, fcB;
+        std::array<const MultiFab*,3> E {&Ex, &Ey, &Ez};
+        std::array<const MultiFab*,3> B {&Bx, &By, &Bz};
+        std::array<const MultiFab*,3> cE {cEx, cEy, cEz};
+        std::array<const MultiFab*,3> cB {cBx, cBy, cBz};
+        const Real* sex = fdtd_nci_stencilz_ex[lev].data();
+        const Real* sby = fdtd_nci_stencilz_by[lev].data();
+        const int n = nstencilz_fdtd_nci_corr;
+
+        fE[0] = GodfreyFilter(Ex, sex, n);  E[0] = fE[0].get();
+        fE[2] = GodfreyFilter(Ez, sby, n);  E[2] = fE[2].get();
+        fB[1] = GodfreyFilter(By, sby, n);  B[1] = fB[1].get();
+#if (AMREX_SPACEDIM == 3)
+        fE[1] = GodfreyFilter(Ey, sex, n);  E[1] = fE[1].get();
+        fB[0] = GodfreyFilter(Bx, sby, n);  B[0] = fB[0].get();
+        fB[2] = GodfreyFilter(Bz, sex, n);  B[2] = fB[2].get();
+#endif
+
+        if (cEx)
+        {
+            const Real* csex = fdtd_nci_stencilz_ex[lev-1].data();
+            const Real* csby = fdtd_nci_stencilz_by[lev-1].data();
+            fcE[0] = GodfreyFilter(*cEx, csex, n);  cE[0] = fcE[0].get();
+            fcE[2] = GodfreyFilter(*cEz, csby, n);  cE[2] = fcE[2].get();
+            fcB[1] = GodfreyFilter(*cBy, csby, n);  cB[1] = fcB[1].get();
+#if (AMREX_SPACEDIM == 3)
+            fcE[1] = GodfreyFilter(*cEy, csex, n);  cE[1] = fcE[1].get();
+            fcB[0] = GodfreyFilter(*cBx, csby, n);  cB[0] = fcB[0].get();
+            fcB[2] = GodfreyFilter(*cBz, csex, n);  cB[2] = fcB[2].get();
+#endif
+        }
+
+        for (auto& pc : allcontainers) {
+            pc->Evolve(lev, *E[0], *E[1], *E[2], *B[0], *B[1], *B[2], jx, jy, jz, cjx, cjy, cjz,
+                       rho, crho, cE[0], cE[1], cE[2], cB[0], cB[1], cB[2], t, dt);
+        }
+        return;
+    }
+
     for (auto& pc : allcontainers) {
 	pc->Evolve(lev, Ex, Ey, Ez, Bx, By, Bz, jx, jy, jz, cjx, cjy, cjz,
                    rho, crho, cEx, cEy, cEz, cBx, cBy, cBz, t, dt);
@@ -260,6 +333,61 @@ MultiParticleContainer::GetChargeDensity (int lev, bool local)
     return rho;
 }
 
+std::unique_ptr<MultiFab>
+MultiParticleContainer::GetNumberDensity (int lev)
+{
+    WarpX& warpx = WarpX::GetInstance();
+    const Geometry& gm = warpx.Geom(lev);
+    const Real* problo = gm.ProbLo();
+    const Real* dx = gm.CellSize();
+    const Real inv_vol = 1.0/AMREX_D_TERM(dx[0],*dx[1],*dx[2]);
+
+    auto ndens = std::unique_ptr<MultiFab>(new MultiFab(warpx.boxArray(lev),
+                                                        warpx.DistributionMap(lev), 1, 0));
+    ndens->setVal(0.0);
+
+    // The particles of the finer levels are binned on the grids of their own level,
+    // coarsened to the resolution of `lev`, and then added to `lev`.
+    IntVect ratio = IntVect::TheUnitVector();
+    for (int plev = lev; plev <= warpx.finestLevel(); ++plev)
+    {
+        if (plev > lev) ratio *= warpx.refRatio(plev-1);
+
+        BoxArray cba = warpx.boxArray(plev);
+        cba.coarsen(ratio);
+        MultiFab nlev(cba, warpx.DistributionMap(plev), 1, 0);
+        nlev.setVal(0.0);
+
+        for (int ispecies = 0; ispecies < nspecies; ++ispecies)
+        {
+            // No OpenMP: the tiles of a grid share the same FArrayBox
+            for (WarpXParIter pti(*allcontainers[ispecies], plev); pti.isValid(); ++pti)
+            {
+                FArrayBox& fab = nlev[pti];
+                const Box& bx = fab.box();
+                const auto& particles = pti.GetArrayOfStructs();
+                const auto& wp = pti.GetAttribs(PIdx::w);
+                const long np = pti.numParticles();
+                for (long i = 0; i < np; ++i)
+                {
+                    const auto& p = particles[i];
+                    IntVect iv(AMREX_D_DECL(static_cast<int>(std::floor((p.pos(0)-problo[0])/dx[0])),
+                                            static_cast<int>(std::floor((p.pos(1)-problo[1])/dx[1])),
+                                            static_cast<int>(std::floor((p.pos(2)-problo[2])/dx[2]))));
+                    iv.max(bx.smallEnd());
+                    iv.min(bx.bigEnd());
+                    fab(iv) += wp[i]*inv_vol;
+                }
+            }
+        }
+
+        ndens->ParallelAdd(nlev, 0, 0, 1, IntVect::TheZeroVector(), IntVect::TheZeroVector(),
+                           gm.periodicity());
+    }
+
+    return ndens;
+}
+
 void
 MultiParticleContainer::SortParticlesByCell ()
 {
@@ -268,6 +396,15 @@ MultiParticleContainer::SortParticlesByCell ()
     }
 }
 
+void
+MultiParticleContainer::MergeParticles (int max_ppc)
+{
+    // Only the physical species (not the laser particles)
+    for (int i = 0; i < nspecies; ++i) {
+	allcontainers[i]->MergeParticles(max_ppc);
+    }
+}
+
 void
 MultiParticleContainer::Redistribute ()
 {
@@ -284,6 +421,14 @@ MultiParticleContainer::RedistributeLocal (const int num_ghost)
     }
 }
 
+void
+MultiParticleContainer::RedistributeMovedGrids (int lev, const DistributionMapping& old_dm)
+{
+    for (auto& pc : allcontainers) {
+	pc->RedistributeMovedGrids(lev, old_dm);
+    }
+}
+
 Vector<long>
 MultiParticleContainer::NumberOfParticlesInGrid(int lev) const
 {
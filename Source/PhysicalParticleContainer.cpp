@@ -1,48 +1,70 @@
 #include <limits>
 #include <sstream>
+#include <fstream>
 
 #include <ParticleContainer.H>
 #include <WarpX_f.H>
 #include <WarpX.H>
 #include <WarpXConst.H>
 #include <WarpXWrappers.h>
+#include <WarpXRandom.H>
+#include <WarpXUtil.H>
 
 
 using namespace amrex;
 
+/**
+ * Count the particles that AddPlasma creates in the tile `tile_realbox`,
+ * for the cells of `overlap_box` (whose lower corner is at `overlap_realbox.lo()`).
+ * Particles later rejected by the bounds of the plasma are included in the count.
+ * On output, `cell_fac` holds the refinement factor of each cell of `overlap_box`,
+ * `cell_ppc` its number of particles per cell (before refinement) and
+ * `cell_offset` the index of its first particle in the tile, relative to
+ * the first new particle (`cell_offset` has one more entry than the number of cells).
+ */
 long PhysicalParticleContainer::
-NumParticlesToAdd(const Box& overlap_box, const RealBox& overlap_realbox,
-		  const RealBox& tile_realbox, const RealBox& particle_real_box)
+NumParticlesToAdd(int lev, const Box& overlap_box, const RealBox& overlap_realbox,
+		  const RealBox& tile_realbox,
+		  Vector<int>& cell_fac, Vector<int>& cell_ppc, Vector<long>& cell_offset)
 {
-    const int lev = 0;
     const Geometry& geom = Geom(lev);
-    int num_ppc = plasma_injector->num_particles_per_cell;
     const Real* dx = geom.CellSize();
 
+    const long ncells = overlap_box.numPts();
+    cell_fac.resize(ncells);
+    cell_ppc.resize(ncells);
+    cell_offset.resize(ncells+1);
+
     long np = 0;
+    long icell = 0;
     const auto& overlap_corner = overlap_realbox.lo();
-    for (IntVect iv = overlap_box.smallEnd(); iv <= overlap_box.bigEnd(); overlap_box.next(iv))
+    for (IntVect iv = overlap_box.smallEnd(); iv <= overlap_box.bigEnd(); overlap_box.next(iv), ++icell)
     {
-        int fac;
-	if (injected) {
 #if ( AMREX_SPACEDIM == 3 )
-	    Real x = overlap_corner[0] + (iv[0] + 0.5)*dx[0];
-	    Real y = overlap_corner[1] + (iv[1] + 0.5)*dx[1];
-	    Real z = overlap_corner[2] + (iv[2] + 0.5)*dx[2];
+	const Real xc = overlap_corner[0] + (iv[0] + 0.5)*dx[0];
+	const Real yc = overlap_corner[1] + (iv[1] + 0.5)*dx[1];
+	const Real zc = overlap_corner[2] + (iv[2] + 0.5)*dx[2];
 #elif ( AMREX_SPACEDIM == 2 )
-	    Real x = overlap_corner[0] + (iv[0] + 0.5)*dx[0];
-	    Real y = 0;
-	    Real z = overlap_corner[1] + (iv[1] + 0.5)*dx[1];
+	const Real xc = overlap_corner[0] + (iv[0] + 0.5)*dx[0];
+	const Real yc = 0;
+	const Real zc = overlap_corner[1] + (iv[1] + 0.5)*dx[1];
 #endif
-	    fac = GetRefineFac(x, y, z);
+        int fac;
+	if (injected) {
+	    fac = GetRefineFac(xc, yc, zc);
 	} else {
 	    fac = 1.0;
 	}
+	const std::uint64_t cell_key = InjectionCellKey(lev, overlap_realbox, iv);
+	const int num_ppc = NumParticlesPerCell(lev, xc, yc, zc, cell_key);
+	cell_fac[icell] = fac;
+	cell_ppc[icell] = num_ppc;
+	cell_offset[icell] = np;
 	
 	int ref_num_ppc = num_ppc * AMREX_D_TERM(fac, *fac, *fac);
 	for (int i_part=0; i_part<ref_num_ppc;i_part++) {
 	    std::array<Real, 3> r;
-	    plasma_injector->getPositionUnitBox(r, i_part, fac);
+	    plasma_injector->getPositionUnitBox(r, i_part, fac, cell_key);
 #if ( AMREX_SPACEDIM == 3 )
 	    Real x = overlap_corner[0] + (iv[0] + r[0])*dx[0];
 	    Real y = overlap_corner[1] + (iv[1] + r[1])*dx[1];
@@ -62,10 +84,77 @@ NumParticlesToAdd(const Box& overlap_box, const RealBox& overlap_realbox,
 	    ++np;
 	}
     }
+    cell_offset[ncells] = np;
     
     return np;
 }
 
+/**
+ * Key of the random numbers used for the particles injected in the cell `iv`
+ * of an overlap box whose lower corner is `overlap_realbox.lo()`. It combines
+ * the species, the level and the global index of the cell, so that the same
+ * particles are created whatever the decomposition in boxes, tiles, threads
+ * and ranks. With continuous injection, the index along the moving window
+ * direction is counted on the plasma lattice, from an origin that moves with
+ * the plasma: a cell that is injected over several steps (see
+ * WarpX::ContinuousPlasmaInjection) gets the same particles at every step,
+ * and each step keeps exactly the ones inside its slab.
+ */
+std::uint64_t
+PhysicalParticleContainer::InjectionCellKey (int lev, const RealBox& overlap_realbox,
+                                             const IntVect& iv) const
+{
+    const Geometry& geom = Geom(lev);
+    const Real* dx = geom.CellSize();
+    const Real* problo = geom.ProbLo();
+    const WarpX& warpx = WarpX::GetInstance();
+    const int lattice_dir = warpx.plasmaLatticeDir();
+
+    std::uint64_t key = WarpXRandom::Key(species_id, lev);
+    for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+        const Real origin = (dir == lattice_dir) ? warpx.plasmaLatticeOrigin() : problo[dir];
+        const long i = static_cast<long>(std::floor((overlap_realbox.lo(dir)-origin)/dx[dir] + 0.5))
+                       + iv[dir];
+        key = WarpXRandom::Key(key, static_cast<std::uint64_t>(i));
+    }
+    return key;
+}
+
+/**
+ * Number of particles (before refinement) injected in the cell centered on (x,y,z).
+ * This is the num_particles_per_cell of the species, unless the number of particles
+ * per cell adapts to the local density (`<species>.adaptive_ppc_density`), in which case
+ * the density is evaluated at the center of the cell.
+ */
+int
+PhysicalParticleContainer::NumParticlesPerCell (int lev, Real x, Real y, Real z,
+                                                std::uint64_t cell_key)
+{
+    if (not plasma_injector->adaptive_ppc) return plasma_injector->num_particles_per_cell;
+
+    Real dens = 0.;
+    if (WarpX::gamma_boost == 1.) {
+        if (plasma_injector->insideBounds(x, y, z)) {
+            dens = plasma_injector->getDensity(x, y, z);
+        }
+    } else {
+        // Lab-frame position at t_lab=0, as in AddPlasmaCPU
+        const Real c = PhysConst::c;
+        const Real gamma_boost = WarpX::gamma_boost;
+        const Real beta_boost = WarpX::beta_boost;
+        std::array<Real, 3> u;
+        plasma_injector->getMomentum(u, x, y, 0., WarpXRandom::Mix(cell_key));
+        const Real gamma_lab = std::sqrt( 1 + (u[0]*u[0] + u[1]*u[1] + u[2]*u[2])/(c*c) );
+        const Real betaz_lab = u[2]/gamma_lab/c;
+        const Real t = WarpX::GetInstance().gett_new(lev);
+        const Real z0_lab = gamma_boost * ( z*(1-beta_boost*betaz_lab) - c*t*(betaz_lab-beta_boost) );
+        if (plasma_injector->insideBounds(x, y, z0_lab)) {
+            dens = gamma_boost * plasma_injector->getDensity(x, y, z0_lab) * ( 1 - beta_boost*betaz_lab );
+        }
+    }
+    return plasma_injector->numParticlesPerCell(dens);
+}
+
 PhysicalParticleContainer::PhysicalParticleContainer (AmrCore* amr_core, int ispecies,
                                                       const std::string& name)
     : WarpXParticleContainer(amr_core, ispecies),
@@ -143,31 +232,39 @@ PhysicalParticleContainer::AddGaussianBeam(Real x_m, Real y_m, Real z_m,
     const Geometry& geom     = m_gdb->Geom(0);
     RealBox containing_bx = geom.ProbDomain();
 
-    std::mt19937_64 mt(0451);
-    std::normal_distribution<double> distx(x_m, x_rms);
-    std::normal_distribution<double> disty(y_m, y_rms);
-    std::normal_distribution<double> distz(z_m, z_rms);
+    // Random numbers of particle i are drawn from the key (species, i)
+    const std::uint64_t beam_key = WarpXRandom::Key(species_id, 0);
+
+    // Each rank creates a contiguous share of the particles. Since the random
+    // numbers only depend on the particle index, the beam does not depend on
+    // the number of ranks.
+    long ibegin, iend;
+    SplitAmongRanks(npart, ibegin, iend);
 
     std::array<Real,PIdx::nattribs> attribs;
     attribs.fill(0.0);
 
-    if (ParallelDescriptor::IOProcessor()) {
-       std::array<Real, 3> u;
-       Real weight;
-       for (long i = 0; i < npart; ++i) {
+    //  Add to grid 0 and tile 0
+    // Redistribute() will move them to proper places.
+    auto& particle_tile = GetParticles(0)[std::make_pair(0,0)];
+
+    std::array<Real, 3> u;
+    Real weight;
+    for (long i = ibegin; i < iend; ++i) {
+        const std::uint64_t key = WarpXRandom::Key(beam_key, i);
 #if ( AMREX_SPACEDIM == 3 )
-            weight = q_tot/npart/charge;
-            Real x = distx(mt);
-            Real y = disty(mt);
-            Real z = distz(mt);
+        weight = q_tot/npart/charge;
+        Real x = WarpXRandom::Normal(key, 0, x_m, x_rms);
+        Real y = WarpXRandom::Normal(key, 1, y_m, y_rms);
+        Real z = WarpXRandom::Normal(key, 2, z_m, z_rms);
 #elif ( AMREX_SPACEDIM == 2 )
-            weight = q_tot/npart/charge/y_rms;
-            Real x = distx(mt);
-            Real y = 0.;
-            Real z = distz(mt);
+        weight = q_tot/npart/charge/y_rms;
+        Real x = WarpXRandom::Normal(key, 0, x_m, x_rms);
+        Real y = 0.;
+        Real z = WarpXRandom::Normal(key, 2, z_m, z_rms);
 #endif
         if (plasma_injector->insideBounds(x, y, z)) {
-	    plasma_injector->getMomentum(u, x, y, z);
+            plasma_injector->getMomentum(u, x, y, z, WarpXRandom::Key(key, 1));
             if (WarpX::gamma_boost > 1.) {
                 MapParticletoBoostedFrame(x, y, z, u);
             }
@@ -176,10 +273,83 @@ PhysicalParticleContainer::AddGaussianBeam(Real x_m, Real y_m, Real z_m,
             attribs[PIdx::uz] = u[2];
             attribs[PIdx::w ] = weight;
 
-            AddOneParticle(0, 0, 0, x, y, z, attribs);
+            AddOneParticle(particle_tile, x, y, z, attribs);
+        }
+    }
+    Redistribute();
+}
+
+/**
+ * Read the particles of this species from the binary file `filename`, which
+ * contains, for each particle, 7 doubles in the native byte order: x, y, z
+ * (in meters), ux, uy, uz (normalized momenta u/c, as in the lab frame) and
+ * the weight. Each rank reads a disjoint, contiguous range of particles and
+ * Redistribute then sends them to their owners.
+ */
+void
+PhysicalParticleContainer::AddParticlesFromFile (const std::string& filename)
+{
+    BL_PROFILE("PhysicalParticleContainer::AddParticlesFromFile()");
+
+    constexpr int ncomp = 7;
+    constexpr long particle_bytes = ncomp*sizeof(double);
+
+    std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+    if (!ifs.good()) {
+        amrex::Abort("AddParticlesFromFile: cannot open " + filename);
+    }
+    ifs.seekg(0, std::ios::end);
+    const long file_bytes = ifs.tellg();
+    if (file_bytes % particle_bytes != 0) {
+        amrex::Abort("AddParticlesFromFile: the size of " + filename +
+                     " is not a multiple of 7 doubles");
+    }
+    const long npart = file_bytes / particle_bytes;
+
+    long ibegin, iend;
+    SplitAmongRanks(npart, ibegin, iend);
+
+    std::array<Real,PIdx::nattribs> attribs;
+    attribs.fill(0.0);
+
+    //  Add to grid 0 and tile 0
+    // Redistribute() will move them to proper places.
+    auto& particle_tile = GetParticles(0)[std::make_pair(0,0)];
+
+    // Read by chunks, to bound the memory used by the buffer
+    const long chunk_size = 1 << 20;
+    Vector<double> buffer;
+    ifs.seekg(ibegin*particle_bytes, std::ios::beg);
+    for (long ichunk = ibegin; ichunk < iend; ichunk += chunk_size)
+    {
+        const long n = std::min(chunk_size, iend - ichunk);
+        buffer.resize(n*ncomp);
+        ifs.read(reinterpret_cast<char*>(buffer.dataPtr()), n*particle_bytes);
+        if (!ifs.good()) {
+            amrex::Abort("AddParticlesFromFile: failed to read " + filename);
+        }
+
+        for (long i = 0; i < n; ++i)
+        {
+            const double* data = &buffer[i*ncomp];
+            Real x = data[0];
+            Real y = data[1];
+            Real z = data[2];
+            std::array<Real, 3> u {static_cast<Real>(data[3]*PhysConst::c),
+                                   static_cast<Real>(data[4]*PhysConst::c),
+                                   static_cast<Real>(data[5]*PhysConst::c)};
+            if (WarpX::gamma_boost > 1.) {
+                MapParticletoBoostedFrame(x, y, z, u);
             }
+            attribs[PIdx::ux] = u[0];
+            attribs[PIdx::uy] = u[1];
+            attribs[PIdx::uz] = u[2];
+            attribs[PIdx::w ] = data[6];
+
+            AddOneParticle(particle_tile, x, y, z, attribs);
         }
     }
+
     Redistribute();
 }
 
@@ -200,6 +370,11 @@ PhysicalParticleContainer::AddParticles (int lev)
         return;
     }
 
+    if (plasma_injector->read_from_file) {
+        AddParticlesFromFile(plasma_injector->particle_file);
+        return;
+    }
+
     if (plasma_injector->gaussian_beam) {
         AddGaussianBeam(plasma_injector->x_m,
                         plasma_injector->y_m,
@@ -228,35 +403,39 @@ PhysicalParticleContainer::AddParticles (int lev)
  * @param part_realbox the box in which new particles should be created
  * (this box should correspond to an integer number of cells in each direction,
  * but its boundaries need not be aligned with the actual cells of the simulation)
+ * @param slab_realbox if provided, only the particles inside this box are kept
+ * (this box need not correspond to an integer number of cells, which allows
+ * the continuous injection to fill a fraction of the cells of `part_realbox`)
  */
 void
-PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
+PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox, RealBox slab_realbox)
 {
 #ifdef AMREX_USE_GPU
-  AddPlasmaGPU(lev, part_realbox);
+  AddPlasmaGPU(lev, part_realbox, slab_realbox);
 #else
-  AddPlasmaCPU(lev, part_realbox);
+  AddPlasmaCPU(lev, part_realbox, slab_realbox);
 #endif
 }
 
 void
-PhysicalParticleContainer::AddPlasmaCPU (int lev, RealBox part_realbox)
+PhysicalParticleContainer::AddPlasmaCPU (int lev, RealBox part_realbox, RealBox slab_realbox)
 {
     BL_PROFILE("PhysicalParticleContainer::AddPlasmaCPU");
 
     // If no part_realbox is provided, initialize particles in the whole domain
     const Geometry& geom = Geom(lev);
     if (!part_realbox.ok()) part_realbox = geom.ProbDomain();
-
-    int num_ppc = plasma_injector->num_particles_per_cell;
+    if (!slab_realbox.ok()) slab_realbox = part_realbox;
 
     const Real* dx = geom.CellSize();
 
+    // The weight of a particle is its density times scale_fac, divided by
+    // the number of particles in its cell
     Real scale_fac;
 #if AMREX_SPACEDIM==3
-    scale_fac = dx[0]*dx[1]*dx[2]/num_ppc;
+    scale_fac = dx[0]*dx[1]*dx[2];
 #elif AMREX_SPACEDIM==2
-    scale_fac = dx[0]*dx[1]/num_ppc;
+    scale_fac = dx[0]*dx[1];
 #endif
 
 #ifdef _OPENMP
@@ -270,13 +449,8 @@ PhysicalParticleContainer::AddPlasmaCPU (int lev, RealBox part_realbox)
 
     MultiFab* cost = WarpX::getCosts(lev);
 
-    if ( (not m_refined_injection_mask) and WarpX::do_moving_window)
-    {
-        Box mask_box = geom.Domain();
-        mask_box.setSmall(WarpX::moving_window_dir, 0);
-        mask_box.setBig(WarpX::moving_window_dir, 0);
-        m_refined_injection_mask.reset( new IArrayBox(mask_box));
-        m_refined_injection_mask->setVal(-1);
+    if (injected) {
+        UpdateRefinedInjectionMask();
     }
 
     MFItInfo info;
@@ -291,6 +465,10 @@ PhysicalParticleContainer::AddPlasmaCPU (int lev, RealBox part_realbox)
     {
         std::array<Real,PIdx::nattribs> attribs;
         attribs.fill(0.0);
+        Vector<int> cell_fac, cell_ppc;
+        Vector<long> cell_offset;
+        Vector<Real> rx, ry, rz, xp, yp, zp, zlab, uxp, uyp, uzp, densp;
+        Vector<std::uint64_t> keyp;
 
         // Loop through the tiles
         for (MFIter mfi = MakeMFIter(lev, info); mfi.isValid(); ++mfi) {
@@ -298,7 +476,16 @@ PhysicalParticleContainer::AddPlasmaCPU (int lev, RealBox part_realbox)
             Real wt = amrex::second();
 
             const Box& tile_box = mfi.tilebox();
-            const RealBox tile_realbox = WarpX::getRealBox(tile_box, lev);
+            RealBox tile_realbox = WarpX::getRealBox(tile_box, lev);
+
+            // Only the part of the tile inside slab_realbox is filled
+            for (int dir=0; dir<AMREX_SPACEDIM; dir++) {
+                tile_realbox.setLo( dir, std::max(tile_realbox.lo(dir), slab_realbox.lo(dir)) );
+                tile_realbox.setHi( dir, std::min(tile_realbox.hi(dir), slab_realbox.hi(dir)) );
+            }
+            if (!tile_realbox.ok()) {
+                continue; // Go to the next tile
+            }
 
             // Find the cells of part_box that overlap with tile_realbox
             // If there is no overlap, just go to the next tile in the loop
@@ -332,109 +519,179 @@ PhysicalParticleContainer::AddPlasmaCPU (int lev, RealBox part_realbox)
             const int grid_id = mfi.index();
             const int tile_id = mfi.LocalTileIndex();
 
-            // Loop through the cells of overlap_box and inject
-            // the corresponding particles
+            // First pass: count the particles of this tile (and the index
+            // of the first particle of each cell), so that the storage
+            // of the tile is resized only once.
+            const long np = NumParticlesToAdd(lev, overlap_box, overlap_realbox, tile_realbox,
+                                              cell_fac, cell_ppc, cell_offset);
+            if (np == 0) {
+                continue; // Go to the next tile
+            }
+
+            auto& particle_tile = GetParticles(lev)[std::make_pair(grid_id,tile_id)];
+            const long old_size = particle_tile.GetArrayOfStructs().size();
+            particle_tile.resize(old_size + np);
+
+            auto& aos = particle_tile.GetArrayOfStructs();
+            std::array<Real*,PIdx::nattribs> soa;
+            for (int kk = 0; kk < PIdx::nattribs; ++kk) {
+                soa[kk] = particle_tile.GetStructOfArrays().GetRealData(kk).dataPtr();
+            }
+            for (long i = old_size; i < old_size + np; ++i) {
+                aos[i].id() = -1;
+            }
+
+            // Second pass: fill the new particles by index, one cell at a time.
+            // The positions, momenta and densities of the particles of a cell
+            // are evaluated in batch. The slots that are not filled (particles
+            // rejected by the bounds of the plasma, or random positions that
+            // fall outside the tile more often than in the first pass) keep
+            // an invalid id and are removed below.
             const auto& overlap_corner = overlap_realbox.lo();
-            for (IntVect iv = overlap_box.smallEnd(); iv <= overlap_box.bigEnd(); overlap_box.next(iv))
+            long icell = 0;
+            for (IntVect iv = overlap_box.smallEnd(); iv <= overlap_box.bigEnd(); overlap_box.next(iv), ++icell)
             {
-                int fac;
-                if (injected) {
-#if ( AMREX_SPACEDIM == 3 )
-                    Real x = overlap_corner[0] + (iv[0] + 0.5)*dx[0];
-                    Real y = overlap_corner[1] + (iv[1] + 0.5)*dx[1];
-                    Real z = overlap_corner[2] + (iv[2] + 0.5)*dx[2];
-#elif ( AMREX_SPACEDIM == 2 )
-                    Real x = overlap_corner[0] + (iv[0] + 0.5)*dx[0];
-                    Real y = 0;
-                    Real z = overlap_corner[1] + (iv[1] + 0.5)*dx[1];
-#endif
-                    fac = GetRefineFac(x, y, z);
-                } else {
-                    fac = 1.0;
+                const int fac = cell_fac[icell];
+                const long ip = old_size + cell_offset[icell];
+                const long nslots = cell_offset[icell+1] - cell_offset[icell];
+                if (nslots == 0) continue;
+
+                const int ref_num_ppc = cell_ppc[icell] * AMREX_D_TERM(fac, *fac, *fac);
+                for (auto v : {&rx, &ry, &rz, &xp, &yp, &zp, &zlab, &uxp, &uyp, &uzp, &densp}) {
+                    v->resize(ref_num_ppc);
                 }
-
-                int ref_num_ppc = num_ppc * AMREX_D_TERM(fac, *fac, *fac);
-                for (int i_part=0; i_part<ref_num_ppc;i_part++) {
-                    std::array<Real, 3> r;
-                    plasma_injector->getPositionUnitBox(r, i_part, fac);
-#if ( AMREX_SPACEDIM == 3 )
-                    Real x = overlap_corner[0] + (iv[0] + r[0])*dx[0];
-                    Real y = overlap_corner[1] + (iv[1] + r[1])*dx[1];
-                    Real z = overlap_corner[2] + (iv[2] + r[2])*dx[2];
-#elif ( AMREX_SPACEDIM == 2 )
-                    Real x = overlap_corner[0] + (iv[0] + r[0])*dx[0];
-                    Real y = 0;
-                    Real z = overlap_corner[1] + (iv[1] + r[1])*dx[1];
-#endif
-                    // If the new particle is not inside the tile box,
-                    // go to the next generated particle.
+                keyp.resize(ref_num_ppc);
+                const std::uint64_t cell_key = InjectionCellKey(lev, overlap_realbox, iv);
+                plasma_injector->getPositionsUnitBox(ref_num_ppc, fac, cell_key,
+                                                     rx.dataPtr(), ry.dataPtr(), rz.dataPtr());
+
+                // Keep the particles that are inside the tile box
+                int n = 0;
+                for (int i_part=0; i_part<ref_num_ppc && n<nslots; i_part++) {
 #if ( AMREX_SPACEDIM == 3 )
+                    Real x = overlap_corner[0] + (iv[0] + rx[i_part])*dx[0];
+                    Real y = overlap_corner[1] + (iv[1] + ry[i_part])*dx[1];
+                    Real z = overlap_corner[2] + (iv[2] + rz[i_part])*dx[2];
                     if(!tile_realbox.contains( RealVect{x, y, z} )) continue;
 #elif ( AMREX_SPACEDIM == 2 )
+                    Real x = overlap_corner[0] + (iv[0] + rx[i_part])*dx[0];
+                    Real y = 0;
+                    Real z = overlap_corner[1] + (iv[1] + ry[i_part])*dx[1];
                     if(!tile_realbox.contains( RealVect{x, z} )) continue;
 #endif
+                    xp[n] = x;
+                    yp[n] = y;
+                    zp[n] = z;
+                    keyp[n] = WarpXRandom::Key(cell_key, i_part);
+                    ++n;
+                }
 
-                    Real dens;
-                    std::array<Real, 3> u;
-                    if (WarpX::gamma_boost == 1.){
-                      // Lab-frame simulation
-                      // If the particle is not within the species's
-                      // xmin, xmax, ymin, ymax, zmin, zmax, go to
-                      // the next generated particle.
-                      if (!plasma_injector->insideBounds(x, y, z)) continue;
-                      plasma_injector->getMomentum(u, x, y, z);
-                      dens = plasma_injector->getDensity(x, y, z);
-                    } else {
-                      // Boosted-frame simulation
-                      Real c = PhysConst::c;
-                      Real gamma_boost = WarpX::gamma_boost;
-                      Real beta_boost = WarpX::beta_boost;
-                      // Since the user provides the density distribution
-                      // at t_lab=0 and in the lab-frame coordinates,
-                      // we need to find the lab-frame position of this
-                      // particle at t_lab=0, from its boosted-frame coordinates
-                      // Assuming ballistic motion, this is given by:
-                      // z0_lab = gamma*( z_boost*(1-beta*betaz_lab) - ct_boost*(betaz_lab-beta) )
-                      // where betaz_lab is the speed of the particle in the lab frame
-                      //
-                      // In order for this equation to be solvable, betaz_lab
-                      // is explicitly assumed to have no dependency on z0_lab
-                      plasma_injector->getMomentum(u, x, y, 0.); // No z0_lab dependency
-                      // At this point u is the lab-frame momentum
-                      // => Apply the above formula for z0_lab
-                      Real gamma_lab = std::sqrt( 1 + (u[0]*u[0] + u[1]*u[1] + u[2]*u[2])/(c*c) );
-                      Real betaz_lab = u[2]/gamma_lab/c;
-                      Real t = WarpX::GetInstance().gett_new(lev);
-                      Real z0_lab = gamma_boost * ( z*(1-beta_boost*betaz_lab) - c*t*(betaz_lab-beta_boost) );
-                      // If the particle is not within the lab-frame zmin, zmax, etc.
-                      // go to the next generated particle.
-                      if (!plasma_injector->insideBounds(x, y, z0_lab)) continue;
-                      // call `getDensity` with lab-frame parameters
-                      dens = plasma_injector->getDensity(x, y, z0_lab);
-                      // At this point u and dens are the lab-frame quantities
-                      // => Perform Lorentz transform
-                      dens = gamma_boost * dens * ( 1 - beta_boost*betaz_lab );
-                      u[2] = gamma_boost * ( u[2] -beta_boost*c*gamma_lab );
+                if (WarpX::gamma_boost == 1.){
+                    // Lab-frame simulation
+                    // Only keep the particles that are within the species's
+                    // xmin, xmax, ymin, ymax, zmin, zmax
+                    int m = 0;
+                    for (int i = 0; i < n; ++i) {
+                        if (!plasma_injector->insideBounds(xp[i], yp[i], zp[i])) continue;
+                        xp[m] = xp[i];
+                        yp[m] = yp[i];
+                        zp[m] = zp[i];
+                        keyp[m] = keyp[i];
+                        ++m;
                     }
-                    attribs[PIdx::w ] = dens * scale_fac / (AMREX_D_TERM(fac, *fac, *fac));
-                    attribs[PIdx::ux] = u[0];
-                    attribs[PIdx::uy] = u[1];
-                    attribs[PIdx::uz] = u[2];
+                    n = m;
+                    plasma_injector->getMomenta(n, xp.dataPtr(), yp.dataPtr(), zp.dataPtr(), keyp.dataPtr(),
+                                                uxp.dataPtr(), uyp.dataPtr(), uzp.dataPtr());
+                    plasma_injector->getDensities(n, xp.dataPtr(), yp.dataPtr(), zp.dataPtr(),
+                                                  densp.dataPtr());
+                } else {
+                    // Boosted-frame simulation
+                    const Real c = PhysConst::c;
+                    const Real gamma_boost = WarpX::gamma_boost;
+                    const Real beta_boost = WarpX::beta_boost;
+                    const Real t = WarpX::GetInstance().gett_new(lev);
+                    // Since the user provides the density distribution
+                    // at t_lab=0 and in the lab-frame coordinates,
+                    // we need to find the lab-frame position of these
+                    // particles at t_lab=0, from their boosted-frame coordinates
+                    // Assuming ballistic motion, this is given by:
+                    // z0_lab = gamma*( z_boost*(1-beta*betaz_lab) - ct_boost*(betaz_lab-beta) )
+                    // where betaz_lab is the speed of the particle in the lab frame
+                    //
+                    // In order for this equation to be solvable, betaz_lab
+                    // is explicitly assumed to have no dependency on z0_lab
+                    for (int i = 0; i < n; ++i) zlab[i] = 0.; // No z0_lab dependency
+                    plasma_injector->getMomenta(n, xp.dataPtr(), yp.dataPtr(), zlab.dataPtr(), keyp.dataPtr(),
+                                                uxp.dataPtr(), uyp.dataPtr(), uzp.dataPtr());
+                    // At this point u is the lab-frame momentum
+                    // => Apply the above formula for z0_lab, and only keep the
+                    // particles that are within the lab-frame zmin, zmax, etc.
+                    int m = 0;
+                    for (int i = 0; i < n; ++i) {
+                        const Real gamma_lab = std::sqrt( 1 + (uxp[i]*uxp[i] + uyp[i]*uyp[i] + uzp[i]*uzp[i])/(c*c) );
+                        const Real betaz_lab = uzp[i]/gamma_lab/c;
+                        const Real z0_lab = gamma_boost * ( zp[i]*(1-beta_boost*betaz_lab) - c*t*(betaz_lab-beta_boost) );
+                        if (!plasma_injector->insideBounds(xp[i], yp[i], z0_lab)) continue;
+                        xp[m] = xp[i];
+                        yp[m] = yp[i];
+                        zp[m] = zp[i];
+                        zlab[m] = z0_lab;
+                        uxp[m] = uxp[i];
+                        uyp[m] = uyp[i];
+                        uzp[m] = uzp[i];
+                        ++m;
+                    }
+                    n = m;
+                    // call `getDensities` with lab-frame parameters
+                    plasma_injector->getDensities(n, xp.dataPtr(), yp.dataPtr(), zlab.dataPtr(),
+                                                  densp.dataPtr());
+                    // At this point u and dens are the lab-frame quantities
+                    // => Perform Lorentz transform
+                    for (int i = 0; i < n; ++i) {
+                        const Real gamma_lab = std::sqrt( 1 + (uxp[i]*uxp[i] + uyp[i]*uyp[i] + uzp[i]*uzp[i])/(c*c) );
+                        const Real betaz_lab = uzp[i]/gamma_lab/c;
+                        densp[i] = gamma_boost * densp[i] * ( 1 - beta_boost*betaz_lab );
+                        uzp[i] = gamma_boost * ( uzp[i] -beta_boost*c*gamma_lab );
+                    }
+                }
+
+                const Real wfac = scale_fac / ref_num_ppc;
+                for (int i = 0; i < n; ++i) {
+                    attribs[PIdx::w ] = densp[i] * wfac;
+                    attribs[PIdx::ux] = uxp[i];
+                    attribs[PIdx::uy] = uyp[i];
+                    attribs[PIdx::uz] = uzp[i];
 
 #ifdef WARPX_STORE_OLD_PARTICLE_ATTRIBS
-                    attribs[PIdx::xold] = x;
-                    attribs[PIdx::yold] = y;
-                    attribs[PIdx::zold] = z;
+                    attribs[PIdx::xold] = xp[i];
+                    attribs[PIdx::yold] = yp[i];
+                    attribs[PIdx::zold] = zp[i];
 
-                    attribs[PIdx::uxold] = u[0];
-                    attribs[PIdx::uyold] = u[1];
-                    attribs[PIdx::uzold] = u[2];
+                    attribs[PIdx::uxold] = uxp[i];
+                    attribs[PIdx::uyold] = uyp[i];
+                    attribs[PIdx::uzold] = uzp[i];
 #endif
 
-		    AddOneParticle(lev, grid_id, tile_id, x, y, z, attribs);
+                    ParticleType& p = aos[ip+i];
+                    p.id()  = ParticleType::NextID();
+                    p.cpu() = ParallelDescriptor::MyProc();
+#if (AMREX_SPACEDIM == 3)
+                    p.pos(0) = xp[i];
+                    p.pos(1) = yp[i];
+                    p.pos(2) = zp[i];
+#elif (AMREX_SPACEDIM == 2)
+                    p.pos(0) = xp[i];
+                    p.pos(1) = zp[i];
+#endif
+                    for (int kk = 0; kk < PIdx::nattribs; ++kk) {
+                        soa[kk][ip+i] = attribs[kk];
+                    }
                 }
             }
 
+            // Remove the rejected particles
+            RemoveInvalidParticles(particle_tile, old_size);
+
             if (cost) {
 	        wt = (amrex::second() - wt) / tile_box.d_numPts();
                 FArrayBox* costfab = cost->fabPtr(mfi);
@@ -449,23 +706,24 @@ PhysicalParticleContainer::AddPlasmaCPU (int lev, RealBox part_realbox)
 
 #ifdef AMREX_USE_GPU
 void
-PhysicalParticleContainer::AddPlasmaGPU (int lev, RealBox part_realbox)
+PhysicalParticleContainer::AddPlasmaGPU (int lev, RealBox part_realbox, RealBox slab_realbox)
 {
     BL_PROFILE("PhysicalParticleContainer::AddPlasmaGPU");
 
     // If no part_realbox is provided, initialize particles in the whole domain
     const Geometry& geom = Geom(lev);
     if (!part_realbox.ok()) part_realbox = geom.ProbDomain();
-
-    int num_ppc = plasma_injector->num_particles_per_cell;
+    if (!slab_realbox.ok()) slab_realbox = part_realbox;
 
     const Real* dx = geom.CellSize();
 
+    // The weight of a particle is its density times scale_fac, divided by
+    // the number of particles in its cell
     Real scale_fac;
 #if AMREX_SPACEDIM==3
-    scale_fac = dx[0]*dx[1]*dx[2]/num_ppc;
+    scale_fac = dx[0]*dx[1]*dx[2];
 #elif AMREX_SPACEDIM==2
-    scale_fac = dx[0]*dx[1]/num_ppc;
+    scale_fac = dx[0]*dx[1];
 #endif
 
 #ifdef _OPENMP
@@ -479,13 +737,8 @@ PhysicalParticleContainer::AddPlasmaGPU (int lev, RealBox part_realbox)
 
     MultiFab* cost = WarpX::getCosts(lev);
 
-    if ( (not m_refined_injection_mask) and WarpX::do_moving_window)
-    {
-        Box mask_box = geom.Domain();
-        mask_box.setSmall(WarpX::moving_window_dir, 0);
-        mask_box.setBig(WarpX::moving_window_dir, 0);
-        m_refined_injection_mask.reset( new IArrayBox(mask_box));
-        m_refined_injection_mask->setVal(-1);
+    if (injected) {
+        UpdateRefinedInjectionMask();
     }
 
     MFItInfo info;
@@ -507,7 +760,16 @@ PhysicalParticleContainer::AddPlasmaGPU (int lev, RealBox part_realbox)
             Real wt = amrex::second();
 
             const Box& tile_box = mfi.tilebox();
-            const RealBox tile_realbox = WarpX::getRealBox(tile_box, lev);
+            RealBox tile_realbox = WarpX::getRealBox(tile_box, lev);
+
+            // Only the part of the tile inside slab_realbox is filled
+            for (int dir=0; dir<AMREX_SPACEDIM; dir++) {
+                tile_realbox.setLo( dir, std::max(tile_realbox.lo(dir), slab_realbox.lo(dir)) );
+                tile_realbox.setHi( dir, std::min(tile_realbox.hi(dir), slab_realbox.hi(dir)) );
+            }
+            if (!tile_realbox.ok()) {
+                continue; // Go to the next tile
+            }
 
             // Find the cells of part_box that overlap with tile_realbox
             // If there is no overlap, just go to the next tile in the loop
@@ -565,10 +827,20 @@ PhysicalParticleContainer::AddPlasmaGPU (int lev, RealBox part_realbox)
                     fac = 1.0;
                 }
 
+                const std::uint64_t cell_key = InjectionCellKey(lev, overlap_realbox, iv);
+#if ( AMREX_SPACEDIM == 3 )
+                const int num_ppc = NumParticlesPerCell(lev, overlap_corner[0] + (iv[0] + 0.5)*dx[0],
+                                                        overlap_corner[1] + (iv[1] + 0.5)*dx[1],
+                                                        overlap_corner[2] + (iv[2] + 0.5)*dx[2], cell_key);
+#elif ( AMREX_SPACEDIM == 2 )
+                const int num_ppc = NumParticlesPerCell(lev, overlap_corner[0] + (iv[0] + 0.5)*dx[0], 0.,
+                                                        overlap_corner[1] + (iv[1] + 0.5)*dx[1], cell_key);
+#endif
                 int ref_num_ppc = num_ppc * AMREX_D_TERM(fac, *fac, *fac);
                 for (int i_part=0; i_part<ref_num_ppc;i_part++) {
                     std::array<Real, 3> r;
-                    plasma_injector->getPositionUnitBox(r, i_part, fac);
+                    plasma_injector->getPositionUnitBox(r, i_part, fac, cell_key);
+                    const std::uint64_t key = WarpXRandom::Key(cell_key, i_part);
 #if ( AMREX_SPACEDIM == 3 )
                     Real x = overlap_corner[0] + (iv[0] + r[0])*dx[0];
                     Real y = overlap_corner[1] + (iv[1] + r[1])*dx[1];
@@ -594,7 +866,7 @@ PhysicalParticleContainer::AddPlasmaGPU (int lev, RealBox part_realbox)
                       // xmin, xmax, ymin, ymax, zmin, zmax, go to
                       // the next generated particle.
                       if (!plasma_injector->insideBounds(x, y, z)) continue;
-                      plasma_injector->getMomentum(u, x, y, z);
+                      plasma_injector->getMomentum(u, x, y, z, key);
                       dens = plasma_injector->getDensity(x, y, z);
                     } else {
                       // Boosted-frame simulation
@@ -611,7 +883,7 @@ PhysicalParticleContainer::AddPlasmaGPU (int lev, RealBox part_realbox)
                       //
                       // In order for this equation to be solvable, betaz_lab
                       // is explicitly assumed to have no dependency on z0_lab
-                      plasma_injector->getMomentum(u, x, y, 0.); // No z0_lab dependency
+                      plasma_injector->getMomentum(u, x, y, 0., key); // No z0_lab dependency
                       // At this point u is the lab-frame momentum
                       // => Apply the above formula for z0_lab
                       Real gamma_lab = std::sqrt( 1 + (u[0]*u[0] + u[1]*u[1] + u[2]*u[2])/(c*c) );
@@ -628,7 +900,7 @@ PhysicalParticleContainer::AddPlasmaGPU (int lev, RealBox part_realbox)
                       dens = gamma_boost * dens * ( 1 - beta_boost*betaz_lab );
                       u[2] = gamma_boost * ( u[2] -beta_boost*c*gamma_lab );
                     }
-                    attribs[PIdx::w ] = dens * scale_fac / (AMREX_D_TERM(fac, *fac, *fac));
+                    attribs[PIdx::w ] = dens * scale_fac / ref_num_ppc;
                     attribs[PIdx::ux] = u[0];
                     attribs[PIdx::uy] = u[1];
                     attribs[PIdx::uz] = u[2];
@@ -1019,9 +1291,6 @@ PhysicalParticleContainer::Evolve (int lev,
     const std::array<Real,3>& dx = WarpX::CellSize(lev);
     const std::array<Real,3>& cdx = WarpX::CellSize(std::max(lev-1,0));
 
-    const auto& mypc = WarpX::GetInstance().GetPartContainer();
-    const int nstencilz_fdtd_nci_corr = mypc.nstencilz_fdtd_nci_corr;
-
     BL_ASSERT(OnSameGrids(lev,jx));
 
     MultiFab* cost = WarpX::getCosts(lev);
@@ -1046,8 +1315,6 @@ PhysicalParticleContainer::Evolve (int lev,
 	if (local_jy[thread_num]  == nullptr) local_jy[thread_num].reset(  new amrex::FArrayBox());
 	if (local_jz[thread_num]  == nullptr) local_jz[thread_num].reset(  new amrex::FArrayBox());
 
-        FArrayBox filtered_Ex, filtered_Ey, filtered_Ez;
-        FArrayBox filtered_Bx, filtered_By, filtered_Bz;
         std::vector<bool> inexflag;
         Vector<long> pid;
         RealVector tmp;
@@ -1082,69 +1349,6 @@ PhysicalParticleContainer::Evolve (int lev,
             FArrayBox const* byfab = &(By[pti]);
             FArrayBox const* bzfab = &(Bz[pti]);
 
-            if (WarpX::use_fdtd_nci_corr)
-            {
-#if (AMREX_SPACEDIM == 2)
-                const Box& tbox = amrex::grow(pti.tilebox(),{static_cast<int>(WarpX::nox),
-                            static_cast<int>(WarpX::noz)});
-#else
-                const Box& tbox = amrex::grow(pti.tilebox(),{static_cast<int>(WarpX::nox),
-                            static_cast<int>(WarpX::noy),
-                            static_cast<int>(WarpX::noz)});
-#endif
-
-                // both 2d and 3d
-                filtered_Ex.resize(amrex::convert(tbox,WarpX::Ex_nodal_flag));
-                WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_Ex),
-                                        BL_TO_FORTRAN_ANYD(filtered_Ex),
-                                        BL_TO_FORTRAN_ANYD(Ex[pti]),
-                                        mypc.fdtd_nci_stencilz_ex[lev].data(),
-                                        &nstencilz_fdtd_nci_corr);
-                exfab = &filtered_Ex;
-
-                filtered_Ez.resize(amrex::convert(tbox,WarpX::Ez_nodal_flag));
-                WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_Ez),
-                                        BL_TO_FORTRAN_ANYD(filtered_Ez),
-                                        BL_TO_FORTRAN_ANYD(Ez[pti]),
-                                        mypc.fdtd_nci_stencilz_by[lev].data(),
-                                        &nstencilz_fdtd_nci_corr);
-                ezfab = &filtered_Ez;
-
-                filtered_By.resize(amrex::convert(tbox,WarpX::By_nodal_flag));
-                WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_By),
-                                        BL_TO_FORTRAN_ANYD(filtered_By),
-                                        BL_TO_FORTRAN_ANYD(By[pti]),
-                                        mypc.fdtd_nci_stencilz_by[lev].data(),
-                                        &nstencilz_fdtd_nci_corr);
-                byfab = &filtered_By;
-
-#if (AMREX_SPACEDIM == 3)
-                filtered_Ey.resize(amrex::convert(tbox,WarpX::Ey_nodal_flag));
-                WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_Ey),
-                                        BL_TO_FORTRAN_ANYD(filtered_Ey),
-                                        BL_TO_FORTRAN_ANYD(Ey[pti]),
-                                        mypc.fdtd_nci_stencilz_ex[lev].data(),
-                                        &nstencilz_fdtd_nci_corr);
-                eyfab = &filtered_Ey;
-
-                filtered_Bx.resize(amrex::convert(tbox,WarpX::Bx_nodal_flag));
-                WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_Bx),
-                                        BL_TO_FORTRAN_ANYD(filtered_Bx),
-                                        BL_TO_FORTRAN_ANYD(Bx[pti]),
-                                        mypc.fdtd_nci_stencilz_by[lev].data(),
-                                        &nstencilz_fdtd_nci_corr);
-                bxfab = &filtered_Bx;
-
-                filtered_Bz.resize(amrex::convert(tbox,WarpX::Bz_nodal_flag));
-                WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_Bz),
-                                        BL_TO_FORTRAN_ANYD(filtered_Bz),
-                                        BL_TO_FORTRAN_ANYD(Bz[pti]),
-                                        mypc.fdtd_nci_stencilz_ex[lev].data(),
-                                        &nstencilz_fdtd_nci_corr);
-                bzfab = &filtered_Bz;
-#endif
-            }
-
 	    Exp.assign(np,0.0);
 	    Eyp.assign(np,0.0);
 	    Ezp.assign(np,0.0);
@@ -1305,68 +1509,6 @@ PhysicalParticleContainer::Evolve (int lev,
                     const FArrayBox* cbyfab = &(*cBy)[pti];
                     const FArrayBox* cbzfab = &(*cBz)[pti];
 
-                    if (WarpX::use_fdtd_nci_corr)
-                    {
-#if (AMREX_SPACEDIM == 2)
-                        const Box& tbox = amrex::grow(cbox,{static_cast<int>(WarpX::nox),
-                                    static_cast<int>(WarpX::noz)});
-#else
-                        const Box& tbox = amrex::grow(cbox,{static_cast<int>(WarpX::nox),
-                                    static_cast<int>(WarpX::noy),
-                                    static_cast<int>(WarpX::noz)});
-#endif
-
-                        // both 2d and 3d
-                        filtered_Ex.resize(amrex::convert(tbox,WarpX::Ex_nodal_flag));
-                        WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_Ex),
-                                                BL_TO_FORTRAN_ANYD(filtered_Ex),
-                                                BL_TO_FORTRAN_ANYD((*cEx)[pti]),
-                                                mypc.fdtd_nci_stencilz_ex[lev-1].data(),
-                                                &nstencilz_fdtd_nci_corr);
-                        cexfab = &filtered_Ex;
-
-                        filtered_Ez.resize(amrex::convert(tbox,WarpX::Ez_nodal_flag));
-                        WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_Ez),
-                                                BL_TO_FORTRAN_ANYD(filtered_Ez),
-                                                BL_TO_FORTRAN_ANYD((*cEz)[pti]),
-                                                mypc.fdtd_nci_stencilz_by[lev-1].data(),
-                                                &nstencilz_fdtd_nci_corr);
-                        cezfab = &filtered_Ez;
-                        filtered_By.resize(amrex::convert(tbox,WarpX::By_nodal_flag));
-                        WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_By),
-                                                BL_TO_FORTRAN_ANYD(filtered_By),
-                                                BL_TO_FORTRAN_ANYD((*cBy)[pti]),
-                                                mypc.fdtd_nci_stencilz_by[lev-1].data(),
-                                                &nstencilz_fdtd_nci_corr);
-                        cbyfab = &filtered_By;
-
-#if (AMREX_SPACEDIM == 3)
-                        filtered_Ey.resize(amrex::convert(tbox,WarpX::Ey_nodal_flag));
-                        WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_Ey),
-                                                BL_TO_FORTRAN_ANYD(filtered_Ey),
-                                                BL_TO_FORTRAN_ANYD((*cEy)[pti]),
-                                                mypc.fdtd_nci_stencilz_ex[lev-1].data(),
-                                                &nstencilz_fdtd_nci_corr);
-                        ceyfab = &filtered_Ey;
-                        
-                        filtered_Bx.resize(amrex::convert(tbox,WarpX::Bx_nodal_flag));
-                        WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_Bx),
-                                                BL_TO_FORTRAN_ANYD(filtered_Bx),
-                                                BL_TO_FORTRAN_ANYD((*cBx)[pti]),
-                                                mypc.fdtd_nci_stencilz_by[lev-1].data(),
-                                                &nstencilz_fdtd_nci_corr);
-                        cbxfab = &filtered_Bx;
-                        
-                        filtered_Bz.resize(amrex::convert(tbox,WarpX::Bz_nodal_flag));
-                        WRPX_PXR_GODFREY_FILTER(BL_TO_FORTRAN_BOX(filtered_Bz),
-                                                BL_TO_FORTRAN_ANYD(filtered_Bz),
-                                                BL_TO_FORTRAN_ANYD((*cBz)[pti]),
-                                                mypc.fdtd_nci_stencilz_ex[lev-1].data(),
-                                                &nstencilz_fdtd_nci_corr);
-                        cbzfab = &filtered_Bz;
-#endif
-                    }
-                    
                     long ncrse = np - nfine_gather;
                     warpx_geteb_energy_conserving(
                         &ncrse,
@@ -1708,10 +1850,62 @@ void PhysicalParticleContainer::GetParticleSlice(const int direction, const Real
 #endif
 }
 
-int PhysicalParticleContainer::GetRefineFac(const Real x, const Real y, const Real z)
+/**
+ * Build the refinement factor of the injected plasma, for each cell of the
+ * domain in the directions transverse to the moving window (the factor does
+ * not depend on the position along the moving window). A cell is refined by
+ * the ratio of level lev+1 if it is refined up to level lev and is covered,
+ * transversally, by the grids of level lev+1. The mask is only rebuilt when
+ * the grids of the fine levels change.
+ */
+void PhysicalParticleContainer::UpdateRefinedInjectionMask ()
 {
-    if (finestLevel() == 0) return 1;
-    if (not WarpX::refine_plasma) return 1;
+    if (finestLevel() == 0 or not WarpX::refine_plasma) {
+        m_refined_injection_mask.reset();
+        m_refined_injection_grids.clear();
+        return;
+    }
+
+    Vector<BoxArray> fine_grids(finestLevel());
+    for (int lev = 0; lev < finestLevel(); ++lev) {
+        fine_grids[lev] = ParticleBoxArray(lev+1);
+    }
+    if (m_refined_injection_mask and fine_grids == m_refined_injection_grids) return;
+
+    const int dir = WarpX::moving_window_dir;
+    Box mask_box = Geom(0).Domain();
+    mask_box.setSmall(dir, 0);
+    mask_box.setBig(dir, 0);
+    m_refined_injection_mask.reset(new IArrayBox(mask_box));
+    m_refined_injection_mask->setVal(1);
+    IArrayBox& mask = *m_refined_injection_mask;
+
+    int ref_fac = 1;
+    for (int lev = 0; lev < finestLevel(); ++lev)
+    {
+        const int new_fac = ref_fac * m_gdb->refRatio(lev)[dir];
+        const BoxArray& fine_ba = fine_grids[lev];
+        for (int i = 0, N = fine_ba.size(); i < N; ++i)
+        {
+            Box bx = fine_ba[i];
+            bx.coarsen(new_fac);
+            bx.setSmall(dir, 0);
+            bx.setBig(dir, 0);
+            bx &= mask_box;
+            if (not bx.ok()) continue;
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                if (mask(iv) == ref_fac) mask(iv) = new_fac;
+            }
+        }
+        ref_fac = new_fac;
+    }
+
+    m_refined_injection_grids = std::move(fine_grids);
+}
+
+int PhysicalParticleContainer::GetRefineFac(const Real x, const Real y, const Real z) const
+{
+    if (not m_refined_injection_mask) return 1;
 
     IntVect iv;
     const Geometry& geom = Geom(0);
@@ -1733,45 +1927,7 @@ int PhysicalParticleContainer::GetRefineFac(const Real x, const Real y, const Re
                  iv[2]=static_cast<int>(floor((z-offset[2])*geom.InvCellSize(2))););
 
     iv += geom.Domain().smallEnd();
+    iv[WarpX::moving_window_dir] = 0;
 
-    const int dir = WarpX::moving_window_dir;
-
-    IntVect iv2 = iv;
-    iv2[dir] = 0;
-
-    if ( (*m_refined_injection_mask)(iv2) != -1) return (*m_refined_injection_mask)(iv2);
-
-    int ref_fac = 1;
-    for (int lev = 0; lev < finestLevel(); ++lev)
-    {
-        const IntVect rr = m_gdb->refRatio(lev);
-        const BoxArray& fine_ba = this->ParticleBoxArray(lev+1);
-        const int num_boxes = fine_ba.size();
-        Vector<Box> stretched_boxes;
-        const int safety_factor = 4;
-        for (int i = 0; i < num_boxes; ++i)
-        {
-            Box bx = fine_ba[i];
-            bx.coarsen(ref_fac*rr[dir]);
-            bx.setSmall(dir, std::numeric_limits<int>::min()/safety_factor);
-            bx.setBig(dir, std::numeric_limits<int>::max()/safety_factor);
-            stretched_boxes.push_back(bx);
-        }
-
-        BoxArray stretched_ba(stretched_boxes.dataPtr(), stretched_boxes.size());
-
-        const int num_ghost = 0;
-        if ( stretched_ba.intersects(Box(iv, iv), num_ghost) )
-        {
-            ref_fac *= rr[dir];
-        }
-        else
-        {
-            break;
-        }
-    }
-
-    (*m_refined_injection_mask)(iv2) = ref_fac;
-
-    return ref_fac;
+    return (*m_refined_injection_mask)(iv);
 }
@@ -1,11 +1,14 @@
 #include "PlasmaInjector.H"
 
 #include <sstream>
+#include <algorithm>
+#include <cmath>
 
 #include <WarpXConst.H>
 #include <WarpX_f.H>
 #include <AMReX.H>
 #include <WarpX.H>
+#include <WarpXRandom.H>
 
 using namespace amrex;
 
@@ -54,6 +57,14 @@ namespace {
     }
 }
 
+void PlasmaDensityProfile::getDensities(int np, const Real* x, const Real* y, const Real* z,
+                                        Real* dens) const
+{
+    for (int i = 0; i < np; ++i) {
+        dens[i] = getDensity(x[i], y[i], z[i]);
+    }
+}
+
 ConstantDensityProfile::ConstantDensityProfile(Real density)
     : _density(density)
 {}
@@ -63,6 +74,12 @@ Real ConstantDensityProfile::getDensity(Real x, Real y, Real z) const
     return _density;
 }
 
+void ConstantDensityProfile::getDensities(int np, const Real* x, const Real* y, const Real* z,
+                                          Real* dens) const
+{
+    std::fill(dens, dens+np, _density);
+}
+
 CustomDensityProfile::CustomDensityProfile(const std::string& species_name)
 {
     ParmParse pp(species_name);
@@ -87,18 +104,45 @@ Real ParseDensityProfile::getDensity(Real x, Real y, Real z) const
     return parser_evaluate_function(list_var.data(), 3, parser_instance_number);
 }
 
+void ParseDensityProfile::getDensities(int np, const Real* x, const Real* y, const Real* z,
+                                       Real* dens) const
+{
+    parser_evaluate_function_xyz(np, x, y, z, dens, parser_instance_number);
+}
+
+void PlasmaMomentumDistribution::getMomenta(int np, const Real* x, const Real* y, const Real* z,
+                                            const std::uint64_t* keys,
+                                            Real* ux, Real* uy, Real* uz)
+{
+    vec3 u;
+    for (int i = 0; i < np; ++i) {
+        getMomentum(u, x[i], y[i], z[i], keys[i]);
+        ux[i] = u[0];
+        uy[i] = u[1];
+        uz[i] = u[2];
+    }
+}
+
 ConstantMomentumDistribution::ConstantMomentumDistribution(Real ux,
                                                            Real uy,
                                                            Real uz)
     : _ux(ux), _uy(uy), _uz(uz)
 {}
 
-void ConstantMomentumDistribution::getMomentum(vec3& u, Real x, Real y, Real z) {
+void ConstantMomentumDistribution::getMomentum(vec3& u, Real x, Real y, Real z,
+                                               std::uint64_t key) {
     u[0] = _ux;
     u[1] = _uy;
     u[2] = _uz;
 }
 
+void ConstantMomentumDistribution::getMomenta(int np, const Real* x, const Real* y, const Real* z,
+                                              const std::uint64_t* keys, Real* ux, Real* uy, Real* uz) {
+    std::fill(ux, ux+np, _ux);
+    std::fill(uy, uy+np, _uy);
+    std::fill(uz, uz+np, _uz);
+}
+
 CustomMomentumDistribution::CustomMomentumDistribution(const std::string& species_name)
 {
   ParmParse pp(species_name);
@@ -115,10 +159,11 @@ GaussianRandomMomentumDistribution::GaussianRandomMomentumDistribution(Real ux_m
 {
 }
 
-void GaussianRandomMomentumDistribution::getMomentum(vec3& u, Real x, Real y, Real z) {
-    Real ux_th = amrex::RandomNormal(0.0, _ux_th);
-    Real uy_th = amrex::RandomNormal(0.0, _uy_th);
-    Real uz_th = amrex::RandomNormal(0.0, _uz_th);
+void GaussianRandomMomentumDistribution::getMomentum(vec3& u, Real x, Real y, Real z,
+                                                     std::uint64_t key) {
+    Real ux_th = WarpXRandom::Normal(key, 0, 0.0, _ux_th);
+    Real uy_th = WarpXRandom::Normal(key, 1, 0.0, _uy_th);
+    Real uz_th = WarpXRandom::Normal(key, 2, 0.0, _uz_th);
 
     u[0] = _ux_m + ux_th;
     u[1] = _uy_m + uy_th;
@@ -128,12 +173,22 @@ RadialExpansionMomentumDistribution::RadialExpansionMomentumDistribution(Real u_
 {
 }
 
-void RadialExpansionMomentumDistribution::getMomentum(vec3& u, Real x, Real y, Real z) {
+void RadialExpansionMomentumDistribution::getMomentum(vec3& u, Real x, Real y, Real z,
+                                                      std::uint64_t key) {
   u[0] = _u_over_r * x;
   u[1] = _u_over_r * y;
   u[2] = _u_over_r * z;
 }
 
+void RadialExpansionMomentumDistribution::getMomenta(int np, const Real* x, const Real* y, const Real* z,
+                                                     const std::uint64_t* keys, Real* ux, Real* uy, Real* uz) {
+  for (int i = 0; i < np; ++i) {
+    ux[i] = _u_over_r * x[i];
+    uy[i] = _u_over_r * y[i];
+    uz[i] = _u_over_r * z[i];
+  }
+}
+
 ParseMomentumFunction::ParseMomentumFunction(std::string parse_momentum_function_ux,
                                              std::string parse_momentum_function_uy,
                                              std::string parse_momentum_function_uz)
@@ -160,7 +215,7 @@ ParseMomentumFunction::ParseMomentumFunction(std::string parse_momentum_function
                                                            s_var.length());
 }
 
-void ParseMomentumFunction::getMomentum(vec3& u, Real x, Real y, Real z)
+void ParseMomentumFunction::getMomentum(vec3& u, Real x, Real y, Real z, std::uint64_t key)
 {
     std::array<amrex::Real, 3> list_var = {x,y,z};
         u[0] = parser_evaluate_function(list_var.data(), 3, parser_instance_number_ux);
@@ -168,21 +223,41 @@ void ParseMomentumFunction::getMomentum(vec3& u, Real x, Real y, Real z)
         u[2] = parser_evaluate_function(list_var.data(), 3, parser_instance_number_uz);
 }
 
+void ParseMomentumFunction::getMomenta(int np, const Real* x, const Real* y, const Real* z,
+                                       const std::uint64_t* keys, Real* ux, Real* uy, Real* uz)
+{
+    parser_evaluate_function_xyz(np, x, y, z, ux, parser_instance_number_ux);
+    parser_evaluate_function_xyz(np, x, y, z, uy, parser_instance_number_uy);
+    parser_evaluate_function_xyz(np, x, y, z, uz, parser_instance_number_uz);
+}
+
+void PlasmaParticlePosition::getPositionsUnitBox(int np, int ref_fac, std::uint64_t cell_key,
+                                                 Real* rx, Real* ry, Real* rz)
+{
+    vec3 r;
+    for (int i_part = 0; i_part < np; ++i_part) {
+        getPositionUnitBox(r, i_part, ref_fac, cell_key);
+        rx[i_part] = r[0];
+        ry[i_part] = r[1];
+        rz[i_part] = r[2];
+    }
+}
+
 RandomPosition::RandomPosition(int num_particles_per_cell):
   _num_particles_per_cell(num_particles_per_cell)
 {}
 
-void RandomPosition::getPositionUnitBox(vec3& r, int i_part, int ref_fac){
-    r[0] = amrex::Random();
-    r[1] = amrex::Random();
-    r[2] = amrex::Random();
+void RandomPosition::getPositionUnitBox(vec3& r, int i_part, int ref_fac, std::uint64_t cell_key){
+    r[0] = WarpXRandom::Uniform(cell_key, 3*i_part);
+    r[1] = WarpXRandom::Uniform(cell_key, 3*i_part+1);
+    r[2] = WarpXRandom::Uniform(cell_key, 3*i_part+2);
 }
 
 RegularPosition::RegularPosition(const amrex::Vector<int>& num_particles_per_cell_each_dim)
     : _num_particles_per_cell_each_dim(num_particles_per_cell_each_dim)
 {}
 
-void RegularPosition::getPositionUnitBox(vec3& r, int i_part, int ref_fac)
+void RegularPosition::getPositionUnitBox(vec3& r, int i_part, int ref_fac, std::uint64_t cell_key)
 {
   int nx = ref_fac*_num_particles_per_cell_each_dim[0];
   int ny = ref_fac*_num_particles_per_cell_each_dim[1];
@@ -201,6 +276,28 @@ void RegularPosition::getPositionUnitBox(vec3& r, int i_part, int ref_fac)
   r[2] = (0.5+iz_part)/nz;
 }
 
+void RegularPosition::getPositionsUnitBox(int np, int ref_fac, std::uint64_t cell_key,
+                                          Real* rx, Real* ry, Real* rz)
+{
+  int nx = ref_fac*_num_particles_per_cell_each_dim[0];
+  int ny = ref_fac*_num_particles_per_cell_each_dim[1];
+#if AMREX_SPACEDIM == 3
+  int nz = ref_fac*_num_particles_per_cell_each_dim[2];
+#else
+  int nz = 1;
+#endif
+
+  for (int i_part = 0; i_part < np; ++i_part) {
+    int ix_part = i_part/(ny * nz);
+    int iy_part = (i_part % (ny * nz)) % ny;
+    int iz_part = (i_part % (ny * nz)) / ny;
+
+    rx[i_part] = (0.5+ix_part)/nx;
+    ry[i_part] = (0.5+iy_part)/ny;
+    rz[i_part] = (0.5+iz_part)/nz;
+  }
+}
+
 PlasmaInjector::PlasmaInjector(int ispecies, const std::string& name)
     : species_id(ispecies), species_name(name)
 {
@@ -241,6 +338,10 @@ PlasmaInjector::PlasmaInjector(int ispecies, const std::string& name)
         pp.get("single_particle_weight", single_particle_weight);
         add_single_particle = true;
         return;
+    } else if (part_pos_s == "binary_file") {
+        pp.get("particle_file", particle_file);
+        read_from_file = true;
+        return;
     } else if (part_pos_s == "gaussian_beam") {
         pp.get("x_m", x_m);
         pp.get("y_m", y_m);
@@ -256,6 +357,13 @@ PlasmaInjector::PlasmaInjector(int ispecies, const std::string& name)
     else if (part_pos_s == "nrandompercell") {
         pp.query("num_particles_per_cell", num_particles_per_cell);
         part_pos.reset(new RandomPosition(num_particles_per_cell));
+        if (pp.query("adaptive_ppc_density", adaptive_ppc_density)) {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(adaptive_ppc_density > 0.,
+                "adaptive_ppc_density must be positive");
+            adaptive_ppc = true;
+            pp.query("adaptive_ppc_min", adaptive_ppc_min);
+            adaptive_ppc_min = std::min(adaptive_ppc_min, num_particles_per_cell);
+        }
         parseDensity(pp);
         parseMomentum(pp);
     } else if (part_pos_s == "nuniformpercell") {
@@ -265,6 +373,8 @@ PlasmaInjector::PlasmaInjector(int ispecies, const std::string& name)
         num_particles_per_cell_each_dim[2] = 1;
 #endif
         part_pos.reset(new RegularPosition(num_particles_per_cell_each_dim));
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(not pp.contains("adaptive_ppc_density"),
+            "adaptive_ppc_density requires injection_style = NRandomPerCell");
         num_particles_per_cell = num_particles_per_cell_each_dim[0] *
                                  num_particles_per_cell_each_dim[1] *
                                  num_particles_per_cell_each_dim[2];
@@ -306,8 +416,6 @@ void PlasmaInjector::parseDensity(ParmParse pp){
     } else if (rho_prof_s == "custom") {
         rho_prof.reset(new CustomDensityProfile(species_name));
     } else if (rho_prof_s == "parse_density_function") {
-        // Serialize particle initialization
-        WarpX::serialize_ics = true;
         pp.get("density_function(x,y,z)", str_density_function);
         rho_prof.reset(new ParseDensityProfile(str_density_function));
     } else {
@@ -353,8 +461,6 @@ void PlasmaInjector::parseMomentum(ParmParse pp){
         pp.query("u_over_r", u_over_r);
         mom_dist.reset(new RadialExpansionMomentumDistribution(u_over_r));
     } else if (mom_dist_s == "parse_momentum_function") {
-        // Serialize particle initialization
-        WarpX::serialize_ics = true;
         pp.get("momentum_function_ux(x,y,z)", str_momentum_function_ux);
         pp.get("momentum_function_uy(x,y,z)", str_momentum_function_uy);
         pp.get("momentum_function_uz(x,y,z)", str_momentum_function_uz);
@@ -366,17 +472,39 @@ void PlasmaInjector::parseMomentum(ParmParse pp){
     }
 }
 
-void PlasmaInjector::getPositionUnitBox(vec3& r, int i_part, int ref_fac) {
-    return part_pos->getPositionUnitBox(r, i_part, ref_fac);
+void PlasmaInjector::getPositionUnitBox(vec3& r, int i_part, int ref_fac, std::uint64_t cell_key) {
+    return part_pos->getPositionUnitBox(r, i_part, ref_fac, cell_key);
 }
 
-void PlasmaInjector::getMomentum(vec3& u, Real x, Real y, Real z) {
-    mom_dist->getMomentum(u, x, y, z);
+void PlasmaInjector::getPositionsUnitBox(int np, int ref_fac, std::uint64_t cell_key,
+                                         Real* rx, Real* ry, Real* rz) {
+    part_pos->getPositionsUnitBox(np, ref_fac, cell_key, rx, ry, rz);
+}
+
+void PlasmaInjector::getMomentum(vec3& u, Real x, Real y, Real z, std::uint64_t key) {
+    mom_dist->getMomentum(u, x, y, z, key);
     u[0] *= PhysConst::c;
     u[1] *= PhysConst::c;
     u[2] *= PhysConst::c;
 }
 
+void PlasmaInjector::getMomenta(int np, const Real* x, const Real* y, const Real* z,
+                                const std::uint64_t* keys, Real* ux, Real* uy, Real* uz) {
+    mom_dist->getMomenta(np, x, y, z, keys, ux, uy, uz);
+    for (int i = 0; i < np; ++i) {
+        ux[i] *= PhysConst::c;
+        uy[i] *= PhysConst::c;
+        uz[i] *= PhysConst::c;
+    }
+}
+
+int PlasmaInjector::numParticlesPerCell(Real dens) const {
+    if (not adaptive_ppc) return num_particles_per_cell;
+    const Real ppc = std::ceil(num_particles_per_cell*std::abs(dens)/adaptive_ppc_density);
+    if (ppc >= num_particles_per_cell) return num_particles_per_cell;
+    return std::max(static_cast<int>(ppc), adaptive_ppc_min);
+}
+
 bool PlasmaInjector::insideBounds(Real x, Real y, Real z) {
   if (x >= xmax || x < xmin ||
       y >= ymax || y < ymin ||
@@ -387,3 +515,8 @@ bool PlasmaInjector::insideBounds(Real x, Real y, Real z) {
 Real PlasmaInjector::getDensity(Real x, Real y, Real z) {
     return rho_prof->getDensity(x, y, z);
 }
+
+void PlasmaInjector::getDensities(int np, const Real* x, const Real* y, const Real* z,
+                                  Real* dens) {
+    rho_prof->getDensities(np, x, y, z, dens);
+}
@@ -17,6 +17,7 @@
 #include <WarpXConst.H>
 #include <WarpXWrappers.h>
 #include <WarpXUtil.H>
+#include <WarpXFilter.H>
 
 #ifdef BL_USE_SENSEI_INSITU
 #include <AMReX_AmrMeshInSituBridge.H>
@@ -48,10 +49,14 @@ int  WarpX::l_lower_order_in_v = true;
 
 bool WarpX::use_laser         = false;
 bool WarpX::use_filter        = false;
+int  WarpX::filter_npass      = 1;
+bool WarpX::filter_compensation = false;
 bool WarpX::serialize_ics     = false;
 bool WarpX::refine_plasma     = false;
 
 int  WarpX::sort_int = -1;
+int  WarpX::merge_int = -1;
+int  WarpX::merge_max_ppc = 16;
 
 bool WarpX::do_boosted_frame_diagnostic = false;
 int  WarpX::num_snapshots_lab = std::numeric_limits<int>::lowest();
@@ -262,9 +267,6 @@ WarpX::ReadParameters ()
 	pp.query("regrid_int", regrid_int);
         pp.query("do_subcycling", do_subcycling);
 
-        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(do_subcycling != 1 || max_level <= 1,
-                                         "Subcycling method 1 only works for 2 levels.");
-
         ReadBoostedFrameParameters(gamma_boost, beta_boost, boost_direction);
 
         pp.queryarr("B_external", B_external);
@@ -294,6 +296,12 @@ WarpX::ReadParameters ()
 
 	    pp.get("moving_window_v", moving_window_v);
 	    moving_window_v *= PhysConst::c;
+
+	    pp.query("moving_window_recycle_boxes", moving_window_recycle_boxes);
+	    if (moving_window_recycle_boxes) {
+		AMREX_ALWAYS_ASSERT_WITH_MESSAGE(max_level == 0,
+		    "warpx.moving_window_recycle_boxes only works with a single level");
+	    }
 	}
 
 	pp.query("do_plasma_injection", do_plasma_injection);
@@ -309,6 +317,7 @@ WarpX::ReadParameters ()
                 // Inject particles continuously from the left end of the box
                 current_injection_position = geom[0].ProbLo(moving_window_dir);
             }
+            plasma_lattice_origin = current_injection_position;
 	}
 
         pp.query("do_boosted_frame_diagnostic", do_boosted_frame_diagnostic);
@@ -344,16 +353,37 @@ WarpX::ReadParameters ()
 
 	pp.query("use_laser", use_laser);
 	pp.query("use_filter", use_filter);
+	pp.query("filter_npass", filter_npass);
+	pp.query("filter_compensation", filter_compensation);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(filter_npass >= 1, "warpx.filter_npass must be >= 1");
 	pp.query("serialize_ics", serialize_ics);
 	pp.query("refine_plasma", refine_plasma);
         pp.query("do_dive_cleaning", do_dive_cleaning);
         pp.query("n_field_gather_buffer", n_field_gather_buffer);
         pp.query("n_current_deposition_buffer", n_current_deposition_buffer);
 	pp.query("sort_int", sort_int);
+	pp.query("merge_int", merge_int);
+	pp.query("merge_max_ppc", merge_max_ppc);
+	if (merge_int > 0) {
+	    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(merge_max_ppc >= 2,
+		"warpx.merge_max_ppc must be at least 2");
+	}
 
         pp.query("do_pml", do_pml);
         pp.query("pml_ncell", pml_ncell);
         pp.query("pml_delta", pml_delta);
+        {
+            std::string s_pml_type = "split";
+            pp.query("pml_type", s_pml_type);
+            std::transform(s_pml_type.begin(), s_pml_type.end(), s_pml_type.begin(), ::tolower);
+            if (s_pml_type == "split") {
+                pml_type = PMLType::Split;
+            } else if (s_pml_type == "convolutional") {
+                pml_type = PMLType::Convolutional;
+            } else {
+                amrex::Abort("Unknown PML type " + s_pml_type);
+            }
+        }
 
         pp.query("plot_raw_fields", plot_raw_fields);
         pp.query("plot_raw_fields_guards", plot_raw_fields_guards);
@@ -400,16 +430,51 @@ WarpX::ReadParameters ()
         }
 
         if (maxLevel() > 0) {
-            Vector<Real> lo, hi;
-            pp.getarr("fine_tag_lo", lo);
-            pp.getarr("fine_tag_hi", hi);
-            fine_tag_lo = RealVect{lo};
-            fine_tag_hi = RealVect{hi};
+            pp.query("tag_particle_density", tag_particle_density);
+            pp.query("tag_E_gradient", tag_E_gradient);
+            std::string str_tag_function;
+            if (pp.query("tag_function(x,y,z,t)", str_tag_function)) {
+                UserConstants my_constants;
+                my_constants.ReadParameters();
+                str_tag_function = my_constants.replaceStringValue(str_tag_function);
+                const std::string s_var = "x,y,z,t";
+                tag_parser_instance_number = parser_initialize_function(str_tag_function.c_str(),
+                                                                        str_tag_function.length(),
+                                                                        s_var.c_str(),
+                                                                        s_var.length());
+            }
+            const bool dynamic_tagging = tag_particle_density > 0.0 || tag_E_gradient > 0.0
+                || tag_parser_instance_number >= 0;
+
+            // The static box is mandatory when no other criterion is given
+            if (!dynamic_tagging || pp.contains("fine_tag_lo")) {
+                Vector<Real> lo, hi;
+                pp.getarr("fine_tag_lo", lo);
+                pp.getarr("fine_tag_hi", hi);
+                fine_tag_lo = RealVect{lo};
+                fine_tag_hi = RealVect{hi};
+                tag_static_box = true;
+            }
         }
 
         pp.query("load_balance_int", load_balance_int);
         pp.query("load_balance_with_sfc", load_balance_with_sfc);
         pp.query("load_balance_knapsack_factor", load_balance_knapsack_factor);
+        pp.query("load_balance_bandwidth", load_balance_bandwidth);
+        pp.query("load_balance_with_cost_model", load_balance_with_cost_model);
+        pp.query("load_balance_with_box_splitting", load_balance_with_box_splitting);
+        pp.query("load_balance_box_cost_fraction", load_balance_box_cost_fraction);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            !(load_balance_with_box_splitting && moving_window_recycle_boxes),
+            "warpx.load_balance_with_box_splitting is incompatible with warpx.moving_window_recycle_boxes");
+        {
+            Vector<Real> coeffs;
+            if (pp.queryarr("costs_model_coefficients", coeffs)) {
+                AMREX_ALWAYS_ASSERT_WITH_MESSAGE(coeffs.size() == 2,
+                    "warpx.costs_model_coefficients requires 2 numbers (cell and particle)");
+                costs_model_coefficients = {{coeffs[0], coeffs[1]}};
+            }
+        }
 
         pp.query("do_dynamic_scheduling", do_dynamic_scheduling);
 
@@ -463,6 +528,9 @@ WarpX::ReadParameters ()
                 amrex::Abort("Unknown FDTD Solver type " + s_solver);
             }
         }
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            pml_type != PMLType::Convolutional || (maxwell_fdtd_solver_id == 0 && !do_nodal),
+            "warpx.pml_type = convolutional only works with the staggered Yee solver");
     }
 
 #ifdef WARPX_USE_PSATD
@@ -544,6 +612,8 @@ WarpX::ClearLevel (int lev)
 
     costs[lev].reset();
 
+    pml[lev].reset();
+
 #ifdef WARPX_USE_PSATD
     for (int i = 0; i < 3; ++i) {
         Efield_fp_fft[lev][i].reset();
@@ -571,12 +641,21 @@ WarpX::ClearLevel (int lev)
 void
 WarpX::AllocLevelData (int lev, const BoxArray& ba, const DistributionMapping& dm)
 {
-    // When using subcycling, the particles on the fine level perform two pushes
-    // before being redistributed ; therefore, we need one extra guard cell
-    // (the particles may move by 2*c*dt)
-    const int ngx_tmp = (maxLevel() > 0 && do_subcycling == 1) ? WarpX::nox+1 : WarpX::nox;
-    const int ngy_tmp = (maxLevel() > 0 && do_subcycling == 1) ? WarpX::noy+1 : WarpX::noy;
-    const int ngz_tmp = (maxLevel() > 0 && do_subcycling == 1) ? WarpX::noz+1 : WarpX::noz;
+    // When using subcycling, the particles on the finest level perform as many
+    // pushes as the cumulative refinement ratio before being redistributed ;
+    // therefore, we need extra guard cells (the particles may move by
+    // nsub*c*dt, i.e. by one cell per push)
+    int ngsub = 0;
+    if (do_subcycling == 1) {
+        int nsub = 1;
+        for (int ilev = 0; ilev < maxLevel(); ++ilev) {
+            nsub *= refRatio(ilev)[0];
+        }
+        ngsub = nsub-1;
+    }
+    const int ngx_tmp = WarpX::nox + ngsub;
+    const int ngy_tmp = WarpX::noy + ngsub;
+    const int ngz_tmp = WarpX::noz + ngsub;
 
     // Ex, Ey, Ez, Bx, By, and Bz have the same number of ghost cells.
     // jx, jy, jz and rho have the same number of ghost cells.
@@ -669,7 +748,7 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
         rho_fp_owner_masks[lev] = std::move(rho_fp[lev]->OwnerMask(period));
     }
     
-    if (do_subcycling == 1 && lev == 0)
+    if (do_subcycling == 1 && lev < maxLevel())
     {
         current_store[lev][0].reset( new MultiFab(amrex::convert(ba,jx_nodal_flag),dm,1,ngJ));
         current_store[lev][1].reset( new MultiFab(amrex::convert(ba,jy_nodal_flag),dm,1,ngJ));
@@ -933,28 +1012,30 @@ WarpX::ComputeDivE (MultiFab& divE, int dcomp,
 void
 WarpX::applyFilter (MultiFab& dstmf, const MultiFab& srcmf, int scomp, int dcomp, int ncomp)
 {
-    ncomp = std::min(ncomp, srcmf.nComp());
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-    {
-        FArrayBox tmpfab;
-        for (MFIter mfi(dstmf,true); mfi.isValid(); ++mfi)
-        {
-            const auto& srcfab = srcmf[mfi];
-            auto& dstfab = dstmf[mfi];
-            const Box& tbx = mfi.growntilebox();
-            const Box& gbx = amrex::grow(tbx,1);
-            tmpfab.resize(gbx,ncomp);
-            tmpfab.setVal(0.0, gbx, 0, ncomp);
-            const Box& ibx = gbx & srcfab.box();
-            tmpfab.copy(srcfab, ibx, scomp, ibx, 0, ncomp);
-            WRPX_FILTER(BL_TO_FORTRAN_BOX(tbx),
-                        BL_TO_FORTRAN_ANYD(tmpfab),
-                        BL_TO_FORTRAN_N_ANYD(dstfab,dcomp),
-                        ncomp);
-        }
+    ApplyBinomialFilter(dstmf, srcmf, filter_npass, filter_compensation, scomp, dcomp, ncomp);
+}
+
+void
+WarpX::applyFilterInPlace (MultiFab& mf, int scomp, int ncomp)
+{
+    ApplyBinomialFilterInPlace(mf, filter_npass, filter_compensation, scomp, ncomp);
+}
+
+/* \brief With use_filter, filter mf in place, guard cells included, then sum
+ * the guard cells of mf into the valid cells of the neighboring boxes.  The
+ * filter is linear, so this is the same as filtering the data of all the boxes
+ * summed up (except for the data that the filter spreads beyond the guard
+ * cells), without allocating any temporary MultiFab or filling the guard
+ * cells.  Data that must be added to mf from another MultiFab (e.g. the
+ * coarse patch of the finer level) should be added before calling this.
+ */
+void
+WarpX::SumBoundaryAndApplyFilter (MultiFab& mf, const Periodicity& period, int scomp, int ncomp)
+{
+    if (use_filter) {
+        applyFilterInPlace(mf, scomp, ncomp);
     }
+    mf.SumBoundary(scomp, ncomp, period);
 }
 
 void
@@ -374,112 +374,41 @@ WarpX::SyncCurrent ()
         SyncCurrent(fine, crse, ref_ratio[0]);
     }
 
-    Vector<Array<std::unique_ptr<MultiFab>,3> > j_fp(finest_level+1);
-    Vector<Array<std::unique_ptr<MultiFab>,3> > j_cp(finest_level+1);
-    Vector<Array<std::unique_ptr<MultiFab>,3> > j_buf(finest_level+1);
-
-    if (WarpX::use_filter) {
-        for (int lev = 0; lev <= finest_level; ++lev) {
-            IntVect ng = current_fp[lev][0]->nGrowVect();
-            ng += 1;
-            for (int idim = 0; idim < 3; ++idim) {
-                j_fp[lev][idim].reset(new MultiFab(current_fp[lev][idim]->boxArray(),
-                                                   current_fp[lev][idim]->DistributionMap(),
-                                                   1, ng));
-                applyFilter(*j_fp[lev][idim], *current_fp[lev][idim]);
-                std::swap(j_fp[lev][idim], current_fp[lev][idim]);
-            }
-        }
-        for (int lev = 1; lev <= finest_level; ++lev) {
-            IntVect ng = current_cp[lev][0]->nGrowVect();
-            ng += 1;
-            for (int idim = 0; idim < 3; ++idim) {
-                j_cp[lev][idim].reset(new MultiFab(current_cp[lev][idim]->boxArray(),
-                                                   current_cp[lev][idim]->DistributionMap(),
-                                                   1, ng));
-                applyFilter(*j_cp[lev][idim], *current_cp[lev][idim]);
-                std::swap(j_cp[lev][idim], current_cp[lev][idim]);
-            }
-        }
-        for (int lev = 1; lev <= finest_level; ++lev) {
-            if (current_buf[lev][0]) {
-                IntVect ng = current_buf[lev][0]->nGrowVect();
-                ng += 1;
-                for (int idim = 0; idim < 3; ++idim) {
-                    j_buf[lev][idim].reset(new MultiFab(current_buf[lev][idim]->boxArray(),
-                                                        current_buf[lev][idim]->DistributionMap(),
-                                                        1, ng));
-                    applyFilter(*j_buf[lev][idim], *current_buf[lev][idim]);
-                    std::swap(*j_buf[lev][idim], *current_buf[lev][idim]);
-                }
+    // Add fine level's coarse patch (and the buffer) to coarse level's fine patch.
+    // The guard cells of the coarse patch are included: they are added before
+    // the fine patch is filtered and summed up.
+    for (int lev = 0; lev < finest_level; ++lev)
+    {
+        const auto& period = Geom(lev).periodicity();
+        const IntVect& ngsrc = current_cp[lev+1][0]->nGrowVect();
+        const IntVect ngdst = IntVect::TheZeroVector();
+        for (int idim = 0; idim < 3; ++idim)
+        {
+            const MultiFab* cc = current_cp[lev+1][idim].get();
+            if (current_buf[lev+1][idim])
+            {
+                MultiFab::Add(*current_buf[lev+1][idim], *cc, 0, 0, 1, ngsrc);
+                cc = current_buf[lev+1][idim].get();
             }
+            current_fp[lev][idim]->copy(*cc,0,0,1,ngsrc,ngdst,period,FabArrayBase::ADD);
         }
     }
 
-    // Sum up fine patch
+    // Filter fine patch, and sum it up
     for (int lev = 0; lev <= finest_level; ++lev)
     {
         const auto& period = Geom(lev).periodicity();
-        current_fp[lev][0]->SumBoundary(period);
-        current_fp[lev][1]->SumBoundary(period);
-        current_fp[lev][2]->SumBoundary(period);
-    }
-
-    // Add fine level's coarse patch to coarse level's fine patch
-    for (int lev = 0; lev < finest_level; ++lev)
-    {
-        const auto& period = Geom(lev).periodicity();
-        const IntVect& ngsrc = current_cp[lev+1][0]->nGrowVect();
-        const IntVect ngdst = IntVect::TheZeroVector();
-        const MultiFab* ccx = current_cp[lev+1][0].get();
-        const MultiFab* ccy = current_cp[lev+1][1].get();
-        const MultiFab* ccz = current_cp[lev+1][2].get();
-        if (current_buf[lev+1][0])
-        {
-            MultiFab::Add(*current_buf[lev+1][0], *current_cp[lev+1][0], 0, 0, 1, ngsrc);
-            MultiFab::Add(*current_buf[lev+1][1], *current_cp[lev+1][1], 0, 0, 1, ngsrc);
-            MultiFab::Add(*current_buf[lev+1][2], *current_cp[lev+1][2], 0, 0, 1, ngsrc);
-            ccx = current_buf[lev+1][0].get();
-            ccy = current_buf[lev+1][1].get();
-            ccz = current_buf[lev+1][2].get();
+        for (int idim = 0; idim < 3; ++idim) {
+            SumBoundaryAndApplyFilter(*current_fp[lev][idim], period);
         }
-        current_fp[lev][0]->copy(*ccx,0,0,1,ngsrc,ngdst,period,FabArrayBase::ADD);
-        current_fp[lev][1]->copy(*ccy,0,0,1,ngsrc,ngdst,period,FabArrayBase::ADD);
-        current_fp[lev][2]->copy(*ccz,0,0,1,ngsrc,ngdst,period,FabArrayBase::ADD);
     }
 
-    // Sum up coarse patch
+    // Filter coarse patch, and sum it up
     for (int lev = 1; lev <= finest_level; ++lev)
     {
         const auto& cperiod = Geom(lev-1).periodicity();
-        current_cp[lev][0]->SumBoundary(cperiod);
-        current_cp[lev][1]->SumBoundary(cperiod);
-        current_cp[lev][2]->SumBoundary(cperiod);
-    }
-
-    if (WarpX::use_filter) {
-        for (int lev = 0; lev <= finest_level; ++lev)
-        {
-            for (int idim = 0; idim < 3; ++idim) {
-                std::swap(j_fp[lev][idim], current_fp[lev][idim]);
-                MultiFab::Copy(*current_fp[lev][idim], *j_fp[lev][idim], 0, 0, 1, 0);
-            }
-        }
-        for (int lev = 1; lev <= finest_level; ++lev)
-        {
-            for (int idim = 0; idim < 3; ++idim) {
-                std::swap(j_cp[lev][idim], current_cp[lev][idim]);
-                MultiFab::Copy(*current_cp[lev][idim], *j_cp[lev][idim], 0, 0, 1, 0);
-            }
-        }
-        for (int lev = 1; lev <= finest_level; ++lev)
-        {
-            for (int idim = 0; idim < 3; ++idim) {
-                if (j_buf[lev][idim]) {
-                    std::swap(j_buf[lev][idim], current_buf[lev][idim]);
-                    MultiFab::Copy(*current_buf[lev][idim], *j_buf[lev][idim], 0, 0, 1, 0);
-                }
-            }
+        for (int idim = 0; idim < 3; ++idim) {
+            SumBoundaryAndApplyFilter(*current_cp[lev][idim], cperiod);
         }
     }
 
@@ -549,53 +478,9 @@ WarpX::SyncRho (amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rhof,
         SyncRho(*rhof[lev], *rhoc[lev], ref_ratio[0]);
     }
 
-    Vector<std::unique_ptr<MultiFab> > rho_f_g(finest_level+1);
-    Vector<std::unique_ptr<MultiFab> > rho_c_g(finest_level+1);
-    Vector<std::unique_ptr<MultiFab> > rho_buf_g(finest_level+1);
-
-    if (WarpX::use_filter) {
-        for (int lev = 0; lev <= finest_level; ++lev) {
-            const int ncomp = rhof[lev]->nComp();
-            IntVect ng = rhof[lev]->nGrowVect();
-            ng += 1;
-            rho_f_g[lev].reset(new MultiFab(rhof[lev]->boxArray(),
-                                            rhof[lev]->DistributionMap(),
-                                            ncomp, ng));
-            applyFilter(*rho_f_g[lev], *rhof[lev]);
-            std::swap(rho_f_g[lev], rhof[lev]);
-        }
-        for (int lev = 1; lev <= finest_level; ++lev) {
-            const int ncomp = rhoc[lev]->nComp();
-            IntVect ng = rhoc[lev]->nGrowVect();
-            ng += 1;
-            rho_c_g[lev].reset(new MultiFab(rhoc[lev]->boxArray(),
-                                            rhoc[lev]->DistributionMap(),
-                                            ncomp, ng));
-            applyFilter(*rho_c_g[lev], *rhoc[lev]);
-            std::swap(rho_c_g[lev], rhoc[lev]);
-        }
-        for (int lev = 1; lev <= finest_level; ++lev) {
-            if (charge_buf[lev]) {
-                const int ncomp = charge_buf[lev]->nComp();
-                IntVect ng = charge_buf[lev]->nGrowVect();
-                ng += 1;
-                rho_buf_g[lev].reset(new MultiFab(charge_buf[lev]->boxArray(),
-                                                  charge_buf[lev]->DistributionMap(),
-                                                  ncomp, ng));
-                applyFilter(*rho_buf_g[lev], *charge_buf[lev]);
-                std::swap(*rho_buf_g[lev], *charge_buf[lev]);
-            }
-        }
-    }
-
-    // Sum up fine patch
-    for (int lev = 0; lev <= finest_level; ++lev)
-    {
-        const auto& period = Geom(lev).periodicity();
-        rhof[lev]->SumBoundary(period);
-    }
-
-    // Add fine level's coarse patch to coarse level's fine patch
+    // Add fine level's coarse patch (and the buffer) to coarse level's fine patch.
+    // The guard cells of the coarse patch are included: they are added before
+    // the fine patch is filtered and summed up.
     for (int lev = 0; lev < finest_level; ++lev)
     {
         const auto& period = Geom(lev).periodicity();
@@ -612,29 +497,18 @@ WarpX::SyncRho (amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rhof,
         rhof[lev]->copy(*crho,0,0,ncomp,ngsrc,ngdst,period,FabArrayBase::ADD);
     }
 
-    // Sum up coarse patch
-    for (int lev = 1; lev <= finest_level; ++lev)
+    // Filter fine patch, and sum it up
+    for (int lev = 0; lev <= finest_level; ++lev)
     {
-        const auto& cperiod = Geom(lev-1).periodicity();
-        rhoc[lev]->SumBoundary(cperiod);
+        const auto& period = Geom(lev).periodicity();
+        SumBoundaryAndApplyFilter(*rhof[lev], period, 0, rhof[lev]->nComp());
     }
 
-    if (WarpX::use_filter) {
-        for (int lev = 0; lev <= finest_level; ++lev) {
-            std::swap(rho_f_g[lev], rhof[lev]);
-            MultiFab::Copy(*rhof[lev], *rho_f_g[lev], 0, 0, rhof[lev]->nComp(), 0);
-        }
-        for (int lev = 1; lev <= finest_level; ++lev) {
-            std::swap(rho_c_g[lev], rhoc[lev]);
-            MultiFab::Copy(*rhoc[lev], *rho_c_g[lev], 0, 0, rhoc[lev]->nComp(), 0);
-        }
-        for (int lev = 1; lev <= finest_level; ++lev)
-        {
-            if (rho_buf_g[lev]) {
-                std::swap(rho_buf_g[lev], charge_buf[lev]);
-                MultiFab::Copy(*charge_buf[lev], *rho_buf_g[lev], 0, 0, rhoc[lev]->nComp(), 0);
-            }
-        }
+    // Filter coarse patch, and sum it up
+    for (int lev = 1; lev <= finest_level; ++lev)
+    {
+        const auto& cperiod = Geom(lev-1).periodicity();
+        SumBoundaryAndApplyFilter(*rhoc[lev], cperiod, 0, rhoc[lev]->nComp());
     }
 
     // sync shared nodal points
@@ -709,16 +583,7 @@ WarpX::ApplyFilterandSumBoundaryJ (int lev, PatchType patch_type)
     const auto& period = Geom(glev).periodicity();
     auto& j = (patch_type == PatchType::fine) ? current_fp[lev] : current_cp[lev];
     for (int idim = 0; idim < 3; ++idim) {
-        if (use_filter) {
-            IntVect ng = j[idim]->nGrowVect();
-            ng += 1;
-            MultiFab jf(j[idim]->boxArray(), j[idim]->DistributionMap(), 1, ng);
-            applyFilter(jf, *j[idim]);
-            jf.SumBoundary(period);
-            MultiFab::Copy(*j[idim], jf, 0, 0, 1, 0);
-        } else {
-            j[idim]->SumBoundary(period);
-        }
+        SumBoundaryAndApplyFilter(*j[idim], period);
     }
 }
 
@@ -738,67 +603,31 @@ WarpX::ApplyFilterandSumBoundaryJ (int lev, PatchType patch_type)
 void
 WarpX::AddCurrentFromFineLevelandSumBoundary (int lev)
 {
-    ApplyFilterandSumBoundaryJ(lev, PatchType::fine);
-
     // When there are current buffers, unlike coarse patch,
     // we don't care about the final state of them.
 
+    // The coarse patch (and buffer) of lev+1 are added, guard cells included,
+    // to the valid cells of the fine patch of lev, before the latter is
+    // filtered and summed up
     const auto& period = Geom(lev).periodicity();
     for (int idim = 0; idim < 3; ++idim) {
-        MultiFab mf(current_fp[lev][idim]->boxArray(),
-                    current_fp[lev][idim]->DistributionMap(), 1, 0);
-        mf.setVal(0.0);
-        if (use_filter && current_buf[lev+1][idim])
-        {
-            // coarse patch of fine level
-            IntVect ng = current_cp[lev+1][idim]->nGrowVect();
-            ng += 1;
-            MultiFab jfc(current_cp[lev+1][idim]->boxArray(),
-                         current_cp[lev+1][idim]->DistributionMap(), 1, ng);
-            applyFilter(jfc, *current_cp[lev+1][idim]);
-
-            // buffer patch of fine level
-            MultiFab jfb(current_buf[lev+1][idim]->boxArray(),
-                         current_buf[lev+1][idim]->DistributionMap(), 1, ng);
-            applyFilter(jfb, *current_buf[lev+1][idim]);
-
-            MultiFab::Add(jfb, jfc, 0, 0, 1, ng);
-            mf.ParallelAdd(jfb, 0, 0, 1, ng, IntVect::TheZeroVector(), period);
-
-            jfc.SumBoundary(period);
-            MultiFab::Copy(*current_cp[lev+1][idim], jfc, 0, 0, 1, 0);
-        }
-        else if (use_filter) // but no buffer
-        {
-            // coarse patch of fine level
-            IntVect ng = current_cp[lev+1][idim]->nGrowVect();
-            ng += 1;
-            MultiFab jf(current_cp[lev+1][idim]->boxArray(),
-                        current_cp[lev+1][idim]->DistributionMap(), 1, ng);
-            applyFilter(jf, *current_cp[lev+1][idim]);
-            mf.ParallelAdd(jf, 0, 0, 1, ng, IntVect::TheZeroVector(), period);
-            jf.SumBoundary(period);
-            MultiFab::Copy(*current_cp[lev+1][idim], jf, 0, 0, 1, 0);
-        }
-        else if (current_buf[lev+1][idim]) // but no filter
+        MultiFab& cp = *current_cp[lev+1][idim];
+        MultiFab* buf = current_buf[lev+1][idim].get();
+        if (buf)
         {
-            MultiFab::Copy(*current_buf[lev+1][idim],
-                           *current_cp [lev+1][idim], 0, 0, 1,
-                           current_cp[lev+1][idim]->nGrow());
-            mf.ParallelAdd(*current_buf[lev+1][idim], 0, 0, 1,
-                           current_buf[lev+1][idim]->nGrowVect(), IntVect::TheZeroVector(),
-                           period);
-            current_cp[lev+1][idim]->SumBoundary(period);
-        }
-        else // no filter, no buffer
-        {
-            mf.ParallelAdd(*current_cp[lev+1][idim], 0, 0, 1,
-                           current_cp[lev+1][idim]->nGrowVect(), IntVect::TheZeroVector(),
-                           period);
-            current_cp[lev+1][idim]->SumBoundary(period);
+            if (use_filter) {
+                MultiFab::Add(*buf, cp, 0, 0, 1, cp.nGrowVect());
+            } else {
+                MultiFab::Copy(*buf, cp, 0, 0, 1, cp.nGrowVect());
+            }
         }
-        MultiFab::Add(*current_fp[lev][idim], mf, 0, 0, 1, 0);
+        const MultiFab& cc = (buf) ? *buf : cp;
+        current_fp[lev][idim]->ParallelAdd(cc, 0, 0, 1, cc.nGrowVect(), IntVect::TheZeroVector(),
+                                           period);
     }
+    ApplyFilterandSumBoundaryJ(lev, PatchType::fine);
+    ApplyFilterandSumBoundaryJ(lev+1, PatchType::coarse);
+
     NodalSyncJ(lev, PatchType::fine);
     NodalSyncJ(lev+1, PatchType::coarse);
 }
@@ -820,16 +649,7 @@ WarpX::ApplyFilterandSumBoundaryRho (int lev, PatchType patch_type, int icomp, i
     const auto& period = Geom(glev).periodicity();
     auto& r = (patch_type == PatchType::fine) ? rho_fp[lev] : rho_cp[lev];
     if (r == nullptr) return;
-    if (use_filter) {
-        IntVect ng = r->nGrowVect();
-        ng += 1;
-        MultiFab rf(r->boxArray(), r->DistributionMap(), ncomp, ng);
-        applyFilter(rf, *r, icomp, 0, ncomp);
-        rf.SumBoundary(period);
-        MultiFab::Copy(*r, rf, 0, icomp, ncomp, 0);
-    } else {
-        r->SumBoundary(icomp, ncomp, period);
-    }
+    SumBoundaryAndApplyFilter(*r, period, icomp, ncomp);
 }
 
 /* /brief Update the charge density of `lev` by adding the charge density from particles
@@ -849,61 +669,25 @@ void
 WarpX::AddRhoFromFineLevelandSumBoundary(int lev, int icomp, int ncomp)
 {
     if (rho_fp[lev]) {
+        // The coarse patch (and buffer) of lev+1 are added, guard cells included,
+        // to the valid cells of the fine patch of lev, before the latter is
+        // filtered and summed up
         const auto& period = Geom(lev).periodicity();
-        MultiFab mf(rho_fp[lev]->boxArray(),
-                    rho_fp[lev]->DistributionMap(),
-                    ncomp, 0);
-        mf.setVal(0.0);
-        if (use_filter && charge_buf[lev+1])
+        MultiFab& rcp = *rho_cp[lev+1];
+        MultiFab* buf = charge_buf[lev+1].get();
+        if (buf)
         {
-            // coarse patch of fine level
-            IntVect ng = rho_cp[lev+1]->nGrowVect();
-            ng += 1;
-            MultiFab rhofc(rho_cp[lev+1]->boxArray(),
-                         rho_cp[lev+1]->DistributionMap(), ncomp, ng);
-            applyFilter(rhofc, *rho_cp[lev+1], icomp, 0, ncomp);
-
-            // buffer patch of fine level
-            MultiFab rhofb(charge_buf[lev+1]->boxArray(),
-                           charge_buf[lev+1]->DistributionMap(), ncomp, ng);
-            applyFilter(rhofb, *charge_buf[lev+1], icomp, 0, ncomp);
-
-            MultiFab::Add(rhofb, rhofc, 0, 0, ncomp, ng);
-            mf.ParallelAdd(rhofb, 0, 0, ncomp, ng, IntVect::TheZeroVector(), period);
-
-            rhofc.SumBoundary(period);
-            MultiFab::Copy(*rho_cp[lev+1], rhofc, 0, 0, ncomp, 0);
-        }
-        else if (use_filter) // but no buffer
-        {
-            IntVect ng = rho_cp[lev+1]->nGrowVect();
-            ng += 1;
-            MultiFab rf(rho_cp[lev+1]->boxArray(), rho_cp[lev+1]->DistributionMap(), ncomp, ng);
-            applyFilter(rf, *rho_cp[lev+1], icomp, 0, ncomp);
-            mf.ParallelAdd(rf, 0, 0, ncomp, ng, IntVect::TheZeroVector(), period);
-            rf.SumBoundary(0, ncomp, period);
-            MultiFab::Copy(*rho_cp[lev+1], rf, 0, icomp, ncomp, 0);
-        }
-        else if (charge_buf[lev+1]) // but no filter
-        {
-            MultiFab::Copy(*charge_buf[lev+1],
-                           *rho_cp[lev+1], icomp, icomp, ncomp,
-                           rho_cp[lev+1]->nGrow());
-            mf.ParallelAdd(*charge_buf[lev+1], icomp, 0,
-                           ncomp,
-                           charge_buf[lev+1]->nGrowVect(), IntVect::TheZeroVector(),
-                           period);
-            rho_cp[lev+1]->SumBoundary(icomp, ncomp, period);
-        }
-        else // no filter, no buffer
-        {
-            mf.ParallelAdd(*rho_cp[lev+1], icomp, 0, ncomp,
-                           rho_cp[lev+1]->nGrowVect(), IntVect::TheZeroVector(),
-                           period);
-            rho_cp[lev+1]->SumBoundary(icomp, ncomp, period);
+            if (use_filter) {
+                MultiFab::Add(*buf, rcp, icomp, icomp, ncomp, rcp.nGrowVect());
+            } else {
+                MultiFab::Copy(*buf, rcp, icomp, icomp, ncomp, rcp.nGrowVect());
+            }
         }
+        const MultiFab& crho = (buf) ? *buf : rcp;
+        rho_fp[lev]->ParallelAdd(crho, icomp, icomp, ncomp, crho.nGrowVect(), IntVect::TheZeroVector(),
+                                 period);
         ApplyFilterandSumBoundaryRho(lev, PatchType::fine, icomp, ncomp);
-        MultiFab::Add(*rho_fp[lev], mf, 0, icomp, ncomp, 0);
+        ApplyFilterandSumBoundaryRho(lev+1, PatchType::coarse, icomp, ncomp);
 
         NodalSyncRho(lev, PatchType::fine, icomp, ncomp);
         NodalSyncRho(lev+1, PatchType::coarse, icomp, ncomp);
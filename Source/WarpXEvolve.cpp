@@ -62,10 +62,6 @@ WarpX::EvolveEM (int numsteps)
 
         if (costs[0] != nullptr)
         {
-#ifdef WARPX_USE_PSATD
-            amrex::Abort("LoadBalance for PSATD: TODO");
-#endif
-
             if (step > 0 && (step+1) % load_balance_int == 0)
             {
                 LoadBalance();
@@ -82,6 +78,11 @@ WarpX::EvolveEM (int numsteps)
             }
         }
 
+        if (regrid_int > 0 && max_level > 0 && step > 0 && step % regrid_int == 0)
+        {
+            Regrid();
+        }
+
         // At the beginning, we have B^{n} and E^{n}.
         // Particles have p^{n} and x^{n}.
         // is_synchronized is true.
@@ -106,8 +107,8 @@ WarpX::EvolveEM (int numsteps)
 
         if (do_subcycling == 0 || finest_level == 0) {
             OneStep_nosub(cur_time);
-        } else if (do_subcycling == 1 && finest_level == 1) {
-            OneStep_sub1(cur_time);
+        } else if (do_subcycling == 1) {
+            OneStep_sub(0, cur_time);
         } else {
             amrex::Print() << "Error: do_subcycling = " << do_subcycling << std::endl;
             amrex::Abort("Unsupported do_subcycling type");
@@ -161,6 +162,13 @@ WarpX::EvolveEM (int numsteps)
 	    mypc->SortParticlesByCell();
 	}
 
+	bool to_merge = (merge_int > 0) && ((step+1) % merge_int == 0);
+	if (to_merge) {
+	    amrex::Print() << "merging particles \n";
+	    if (!to_sort) mypc->SortParticlesByCell();
+	    mypc->MergeParticles(merge_max_ppc);
+	}
+
         amrex::Print()<< "STEP " << step+1 << " ends." << " TIME = " << cur_time
                       << " DT = " << dt[0] << "\n";
         Real walltime_end_step = amrex::second();
@@ -298,153 +306,111 @@ WarpX::OneStep_nosub (Real cur_time)
     FillBoundaryE();
     EvolveF(0.5*dt[0], DtType::SecondHalf);
     EvolveB(0.5*dt[0]); // We now have B^{n+1}
-    if (do_pml) {
-        DampPML();
-        FillBoundaryE();
-    }
     FillBoundaryB();
 #endif
 }
 
 /* /brief Perform one PIC iteration, with subcycling
-*  i.e. The fine patch uses a smaller timestep (and steps more often)
-*  than the coarse patch, for the field advance and particle pusher.
+*  i.e. The fine patches use a smaller timestep (and step more often)
+*  than the coarse patches, for the field advance and particle pusher.
 *
-* This version of subcycling only works for 2 levels and with a refinement
-* ratio of 2.
-* The particles and fields of the fine patch are pushed twice
-* (with dt[coarse]/2) in this routine.
-* The particles of the coarse patch and mother grid are pushed only once
-* (with dt[coarse]). The fields on the coarse patch and mother grid
+* This advances level `lev` by dt[lev], and recursively the finer levels
+* by refRatio(lev) steps of dt[lev+1] each, for any number of levels.
+* The particles of `lev` are pushed only once (with dt[lev]) and their
+* current is kept in current_store, so that it can be combined with the
+* current of each of the refRatio(lev) substeps of the fine level.
+* The fields on the fine patch of `lev` and on the coarse patch of `lev+1`
 * are pushed in a way which is equivalent to pushing once only, with
-* a current which is the average of the coarse + fine current at the 2
-* steps of the fine grid.
-*
+* a current which is the average of the coarse + fine current at the
+* substeps of the fine level.
 */
 void
-WarpX::OneStep_sub1 (Real curtime)
+WarpX::OneStep_sub (int lev, Real cur_time)
 {
     // TODO: we could save some charge depositions
 
-    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(finest_level == 1, "Must have exactly two levels");
-    const int fine_lev = 1;
-    const int coarse_lev = 0;
-
-    // i) Push particles and fields on the fine patch (first fine step)
-    PushParticlesandDepose(fine_lev, curtime);
-    RestrictCurrentFromFineToCoarsePatch(fine_lev);
-    RestrictRhoFromFineToCoarsePatch(fine_lev);
-    ApplyFilterandSumBoundaryJ(fine_lev, PatchType::fine);
-    NodalSyncJ(fine_lev, PatchType::fine);
-    ApplyFilterandSumBoundaryRho(fine_lev, PatchType::fine, 0, 2);
-    NodalSyncRho(fine_lev, PatchType::fine, 0, 2);
-
-    EvolveB(fine_lev, PatchType::fine, 0.5*dt[fine_lev]);
-    EvolveF(fine_lev, PatchType::fine, 0.5*dt[fine_lev], DtType::FirstHalf);
-    FillBoundaryB(fine_lev, PatchType::fine);
-    FillBoundaryF(fine_lev, PatchType::fine);
-
-    EvolveE(fine_lev, PatchType::fine, dt[fine_lev]);
-    FillBoundaryE(fine_lev, PatchType::fine);
-
-    EvolveB(fine_lev, PatchType::fine, 0.5*dt[fine_lev]);
-    EvolveF(fine_lev, PatchType::fine, 0.5*dt[fine_lev], DtType::SecondHalf);
-
-    if (do_pml) {
-        DampPML(fine_lev, PatchType::fine);
-        FillBoundaryE(fine_lev, PatchType::fine);
-    }
-
-    FillBoundaryB(fine_lev, PatchType::fine);
-
-    // ii) Push particles on the coarse patch and mother grid.
-    // Push the fields on the coarse patch and mother grid
-    // by only half a coarse step (first half)
-    PushParticlesandDepose(coarse_lev, curtime);
-    StoreCurrent(coarse_lev);
-    AddCurrentFromFineLevelandSumBoundary(coarse_lev);
-    AddRhoFromFineLevelandSumBoundary(coarse_lev, 0, 1);
-
-    EvolveB(fine_lev, PatchType::coarse, dt[fine_lev]);
-    EvolveF(fine_lev, PatchType::coarse, dt[fine_lev], DtType::FirstHalf);
-    FillBoundaryB(fine_lev, PatchType::coarse);
-    FillBoundaryF(fine_lev, PatchType::coarse);
-
-    EvolveE(fine_lev, PatchType::coarse, dt[fine_lev]);
-    FillBoundaryE(fine_lev, PatchType::coarse);
-
-    EvolveB(coarse_lev, PatchType::fine, 0.5*dt[coarse_lev]);
-    EvolveF(coarse_lev, PatchType::fine, 0.5*dt[coarse_lev], DtType::FirstHalf);
-    FillBoundaryB(coarse_lev, PatchType::fine);
-    FillBoundaryF(coarse_lev, PatchType::fine);
-
-    EvolveE(coarse_lev, PatchType::fine, 0.5*dt[coarse_lev]);
-    FillBoundaryE(coarse_lev, PatchType::fine);
-
-    // iii) Get auxiliary fields on the fine grid, at dt[fine_lev]
-    UpdateAuxilaryData();
-
-    // iv) Push particles and fields on the fine patch (second fine step)
-    PushParticlesandDepose(fine_lev, curtime+dt[fine_lev]);
-    RestrictCurrentFromFineToCoarsePatch(fine_lev);
-    RestrictRhoFromFineToCoarsePatch(fine_lev);
-    ApplyFilterandSumBoundaryJ(fine_lev, PatchType::fine);
-    NodalSyncJ(fine_lev, PatchType::fine);
-    ApplyFilterandSumBoundaryRho(fine_lev, PatchType::fine, 0, 2);
-    NodalSyncRho(fine_lev, PatchType::fine, 0, 2);
-
-    EvolveB(fine_lev, PatchType::fine, 0.5*dt[fine_lev]);
-    EvolveF(fine_lev, PatchType::fine, 0.5*dt[fine_lev], DtType::FirstHalf);
-    FillBoundaryB(fine_lev, PatchType::fine);
-    FillBoundaryF(fine_lev, PatchType::fine);
-
-    EvolveE(fine_lev, PatchType::fine, dt[fine_lev]);
-    FillBoundaryE(fine_lev, PatchType::fine);
-
-    EvolveB(fine_lev, PatchType::fine, 0.5*dt[fine_lev]);
-    EvolveF(fine_lev, PatchType::fine, 0.5*dt[fine_lev], DtType::SecondHalf);
-
-    if (do_pml) {
-        DampPML(fine_lev, PatchType::fine);
-        FillBoundaryE(fine_lev, PatchType::fine);
+    // Push the particles of `lev`, and deposit their current and charge
+    PushParticlesandDepose(lev, cur_time);
+    if (lev > 0) {
+        RestrictCurrentFromFineToCoarsePatch(lev);
+        RestrictRhoFromFineToCoarsePatch(lev);
     }
 
-    FillBoundaryB(fine_lev, PatchType::fine);
-    FillBoundaryF(fine_lev, PatchType::fine);
-
-    // v) Push the fields on the coarse patch and mother grid
-    // by only half a coarse step (second half)
-    RestoreCurrent(coarse_lev);
-    AddCurrentFromFineLevelandSumBoundary(coarse_lev);
-    AddRhoFromFineLevelandSumBoundary(coarse_lev, 1, 1);
+    if (lev == finest_level)
+    {
+        // Finest level: no substeps, push the fields of the fine patch
+        ApplyFilterandSumBoundaryJ(lev, PatchType::fine);
+        NodalSyncJ(lev, PatchType::fine);
+        ApplyFilterandSumBoundaryRho(lev, PatchType::fine, 0, 2);
+        NodalSyncRho(lev, PatchType::fine, 0, 2);
 
-    EvolveE(fine_lev, PatchType::coarse, dt[fine_lev]);
-    FillBoundaryE(fine_lev, PatchType::coarse);
+        EvolveB(lev, PatchType::fine, 0.5*dt[lev]);
+        EvolveF(lev, PatchType::fine, 0.5*dt[lev], DtType::FirstHalf);
+        FillBoundaryB(lev, PatchType::fine);
+        FillBoundaryF(lev, PatchType::fine);
 
-    EvolveB(fine_lev, PatchType::coarse, dt[fine_lev]);
-    EvolveF(fine_lev, PatchType::coarse, dt[fine_lev], DtType::SecondHalf);
+        EvolveE(lev, PatchType::fine, dt[lev]);
+        FillBoundaryE(lev, PatchType::fine);
 
-    if (do_pml) {
-        DampPML(fine_lev, PatchType::coarse); // do it twice
-        DampPML(fine_lev, PatchType::coarse);
-        FillBoundaryE(fine_lev, PatchType::coarse);
+        EvolveB(lev, PatchType::fine, 0.5*dt[lev]);
+        EvolveF(lev, PatchType::fine, 0.5*dt[lev], DtType::SecondHalf);
+        FillBoundaryB(lev, PatchType::fine);
+        FillBoundaryF(lev, PatchType::fine);
+        return;
     }
 
-    FillBoundaryB(fine_lev, PatchType::coarse);
-    FillBoundaryF(fine_lev, PatchType::coarse);
+    const int fine_lev = lev+1;
+    const int nsub = refRatio(lev)[0];
 
-    EvolveE(coarse_lev, PatchType::fine, 0.5*dt[coarse_lev]);
-    FillBoundaryE(coarse_lev, PatchType::fine);
+    for (int isub = 0; isub < nsub; ++isub)
+    {
+        // i) Advance the finer levels by one step of dt[fine_lev]
+        if (isub > 0) UpdateAuxilaryData();
+        OneStep_sub(fine_lev, cur_time + isub*dt[fine_lev]);
+
+        // ii) Add the current of this substep of the fine level to the
+        // current of `lev`, keeping the current of the particles of `lev`
+        // aside for the next substeps.
+        if (isub > 0) RestoreCurrent(lev);
+        if (isub < nsub-1) StoreCurrent(lev);
+        AddCurrentFromFineLevelandSumBoundary(lev);
+        if (isub == 0) AddRhoFromFineLevelandSumBoundary(lev, 0, 1);
+        if (isub == nsub-1) AddRhoFromFineLevelandSumBoundary(lev, 1, 1);
+
+        // iii) Push the fields on the coarse patch of the fine level and
+        // on the fine patch of `lev` by a fraction 1/nsub of dt[lev]
+        if (isub == 0)
+        {
+            EvolveB(fine_lev, PatchType::coarse, 0.5*dt[lev]);
+            EvolveF(fine_lev, PatchType::coarse, 0.5*dt[lev], DtType::FirstHalf);
+            FillBoundaryB(fine_lev, PatchType::coarse);
+            FillBoundaryF(fine_lev, PatchType::coarse);
+
+            EvolveB(lev, PatchType::fine, 0.5*dt[lev]);
+            EvolveF(lev, PatchType::fine, 0.5*dt[lev], DtType::FirstHalf);
+            FillBoundaryB(lev, PatchType::fine);
+            FillBoundaryF(lev, PatchType::fine);
+        }
 
-    EvolveB(coarse_lev, PatchType::fine, 0.5*dt[coarse_lev]);
-    EvolveF(coarse_lev, PatchType::fine, 0.5*dt[coarse_lev], DtType::SecondHalf);
+        EvolveE(fine_lev, PatchType::coarse, dt[fine_lev]);
+        FillBoundaryE(fine_lev, PatchType::coarse);
 
-    if (do_pml) {
-        DampPML(coarse_lev, PatchType::fine);
-        FillBoundaryE(coarse_lev, PatchType::fine);
-    }
+        EvolveE(lev, PatchType::fine, dt[fine_lev]);
+        FillBoundaryE(lev, PatchType::fine);
 
-    FillBoundaryB(coarse_lev, PatchType::fine);
+        if (isub == nsub-1)
+        {
+            EvolveB(fine_lev, PatchType::coarse, 0.5*dt[lev]);
+            EvolveF(fine_lev, PatchType::coarse, 0.5*dt[lev], DtType::SecondHalf);
+            FillBoundaryB(fine_lev, PatchType::coarse);
+            FillBoundaryF(fine_lev, PatchType::coarse);
+
+            EvolveB(lev, PatchType::fine, 0.5*dt[lev]);
+            EvolveF(lev, PatchType::fine, 0.5*dt[lev], DtType::SecondHalf);
+            FillBoundaryB(lev, PatchType::fine);
+            FillBoundaryF(lev, PatchType::fine);
+        }
+    }
 }
 
 void
@@ -538,6 +504,9 @@ WarpX::EvolveB (int lev, PatchType patch_type, amrex::Real dt)
     {
         const auto& pml_B = (patch_type == PatchType::fine) ? pml[lev]->GetB_fp() : pml[lev]->GetB_cp();
         const auto& pml_E = (patch_type == PatchType::fine) ? pml[lev]->GetE_fp() : pml[lev]->GetE_cp();
+        const auto& sigba = (patch_type == PatchType::fine) ? pml[lev]->GetMultiSigmaBox_fp()
+                                                              : pml[lev]->GetMultiSigmaBox_cp();
+        const bool cpml = (pml[lev]->Type() == PMLType::Convolutional);
 
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -548,6 +517,23 @@ WarpX::EvolveB (int lev, PatchType patch_type, amrex::Real dt)
             const Box& tby  = mfi.tilebox(By_nodal_flag);
             const Box& tbz  = mfi.tilebox(Bz_nodal_flag);
 
+            if (cpml)
+            {
+                warpx_push_bvec(
+			      tbx.loVect(), tbx.hiVect(),
+			      tby.loVect(), tby.hiVect(),
+			      tbz.loVect(), tbz.hiVect(),
+			      BL_TO_FORTRAN_3D((*pml_E[0])[mfi]),
+			      BL_TO_FORTRAN_3D((*pml_E[1])[mfi]),
+			      BL_TO_FORTRAN_3D((*pml_E[2])[mfi]),
+			      BL_TO_FORTRAN_3D((*pml_B[0])[mfi]),
+			      BL_TO_FORTRAN_3D((*pml_B[1])[mfi]),
+			      BL_TO_FORTRAN_3D((*pml_B[2])[mfi]),
+			      &dtsdx[0], &dtsdx[1], &dtsdx[2],
+			      &WarpX::maxwell_fdtd_solver_id);
+                continue;
+            }
+
             WRPX_PUSH_PML_BVEC(
 			     tbx.loVect(), tbx.hiVect(),
 			     tby.loVect(), tby.hiVect(),
@@ -559,8 +545,11 @@ WarpX::EvolveB (int lev, PatchType patch_type, amrex::Real dt)
 			     BL_TO_FORTRAN_3D((*pml_B[1])[mfi]),
 			     BL_TO_FORTRAN_3D((*pml_B[2])[mfi]),
 			     &dtsdx[0], &dtsdx[1], &dtsdx[2],
-			     &WarpX::maxwell_fdtd_solver_id);
+			     &WarpX::maxwell_fdtd_solver_id,
+			     &dt, WRPX_PML_TO_FORTRAN(sigba[mfi]));
         }
+
+        if (cpml) pml[lev]->PushMemoryB(patch_type, dt);
     }
 }
 
@@ -687,6 +676,9 @@ WarpX::EvolveE (int lev, PatchType patch_type, amrex::Real dt)
         const auto& pml_B = (patch_type == PatchType::fine) ? pml[lev]->GetB_fp() : pml[lev]->GetB_cp();
         const auto& pml_E = (patch_type == PatchType::fine) ? pml[lev]->GetE_fp() : pml[lev]->GetE_cp();
         const auto& pml_F = (patch_type == PatchType::fine) ? pml[lev]->GetF_fp() : pml[lev]->GetF_cp();
+        const auto& sigba = (patch_type == PatchType::fine) ? pml[lev]->GetMultiSigmaBox_fp()
+                                                              : pml[lev]->GetMultiSigmaBox_cp();
+        const bool cpml = (pml[lev]->Type() == PMLType::Convolutional);
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
@@ -696,6 +688,35 @@ WarpX::EvolveE (int lev, PatchType patch_type, amrex::Real dt)
             const Box& tey  = mfi.tilebox(Ey_nodal_flag);
             const Box& tez  = mfi.tilebox(Ez_nodal_flag);
 
+            if (cpml)
+            {
+                WRPX_PUSH_CPML_EVEC(
+				  tex.loVect(), tex.hiVect(),
+				  tey.loVect(), tey.hiVect(),
+				  tez.loVect(), tez.hiVect(),
+				  BL_TO_FORTRAN_3D((*pml_E[0])[mfi]),
+				  BL_TO_FORTRAN_3D((*pml_E[1])[mfi]),
+				  BL_TO_FORTRAN_3D((*pml_E[2])[mfi]),
+				  BL_TO_FORTRAN_3D((*pml_B[0])[mfi]),
+				  BL_TO_FORTRAN_3D((*pml_B[1])[mfi]),
+				  BL_TO_FORTRAN_3D((*pml_B[2])[mfi]),
+				  &dtsdx_c2[0], &dtsdx_c2[1], &dtsdx_c2[2]);
+                if (pml_F)
+                {
+                    warpx_push_evec_f(
+				  tex.loVect(), tex.hiVect(),
+				  tey.loVect(), tey.hiVect(),
+				  tez.loVect(), tez.hiVect(),
+				  BL_TO_FORTRAN_3D((*pml_E[0])[mfi]),
+				  BL_TO_FORTRAN_3D((*pml_E[1])[mfi]),
+				  BL_TO_FORTRAN_3D((*pml_E[2])[mfi]),
+				  BL_TO_FORTRAN_3D((*pml_F   )[mfi]),
+				  &dtsdx_c2[0], &dtsdx_c2[1], &dtsdx_c2[2],
+				  &WarpX::maxwell_fdtd_solver_id);
+                }
+                continue;
+            }
+
             WRPX_PUSH_PML_EVEC(
 			     tex.loVect(), tex.hiVect(),
 			     tey.loVect(), tey.hiVect(),
@@ -706,7 +727,8 @@ WarpX::EvolveE (int lev, PatchType patch_type, amrex::Real dt)
 			     BL_TO_FORTRAN_3D((*pml_B[0])[mfi]),
 			     BL_TO_FORTRAN_3D((*pml_B[1])[mfi]),
 			     BL_TO_FORTRAN_3D((*pml_B[2])[mfi]),
-			     &dtsdx_c2[0], &dtsdx_c2[1], &dtsdx_c2[2]);
+			     &dtsdx_c2[0], &dtsdx_c2[1], &dtsdx_c2[2],
+			     &dt, WRPX_PML_TO_FORTRAN(sigba[mfi]));
 
             if (pml_F)
             {
@@ -719,9 +741,12 @@ WarpX::EvolveE (int lev, PatchType patch_type, amrex::Real dt)
 				   BL_TO_FORTRAN_3D((*pml_E[2])[mfi]),
 				   BL_TO_FORTRAN_3D((*pml_F   )[mfi]),
 				   &dtsdx_c2[0], &dtsdx_c2[1], &dtsdx_c2[2],
-				   &WarpX::maxwell_fdtd_solver_id);
+				   &WarpX::maxwell_fdtd_solver_id,
+				   &dt, WRPX_PML_TO_FORTRAN(sigba[mfi]));
             }
         }
+
+        if (cpml) pml[lev]->PushMemoryE(patch_type, dt);
     }
 }
 
@@ -787,6 +812,9 @@ WarpX::EvolveF (int lev, PatchType patch_type, Real dt, DtType dt_type)
     {
         const auto& pml_F = (patch_type == PatchType::fine) ? pml[lev]->GetF_fp() : pml[lev]->GetF_cp();
         const auto& pml_E = (patch_type == PatchType::fine) ? pml[lev]->GetE_fp() : pml[lev]->GetE_cp();
+        const auto& sigba = (patch_type == PatchType::fine) ? pml[lev]->GetMultiSigmaBox_fp()
+                                                              : pml[lev]->GetMultiSigmaBox_cp();
+        const bool cpml = (pml[lev]->Type() == PMLType::Convolutional);
 
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -794,79 +822,26 @@ WarpX::EvolveF (int lev, PatchType patch_type, Real dt, DtType dt_type)
         for ( MFIter mfi(*pml_F, TilingIfNotGPU()); mfi.isValid(); ++mfi )
         {
             const Box& bx = mfi.tilebox();
+            if (cpml)
+            {
+                WRPX_PUSH_CPML_F(bx.loVect(), bx.hiVect(),
+			       BL_TO_FORTRAN_ANYD((*pml_F   )[mfi]),
+			       BL_TO_FORTRAN_ANYD((*pml_E[0])[mfi]),
+			       BL_TO_FORTRAN_ANYD((*pml_E[1])[mfi]),
+			       BL_TO_FORTRAN_ANYD((*pml_E[2])[mfi]),
+			       &dtsdx[0], &dtsdx[1], &dtsdx[2]);
+                continue;
+            }
             WRPX_PUSH_PML_F(bx.loVect(), bx.hiVect(),
 			  BL_TO_FORTRAN_ANYD((*pml_F   )[mfi]),
 			  BL_TO_FORTRAN_ANYD((*pml_E[0])[mfi]),
 			  BL_TO_FORTRAN_ANYD((*pml_E[1])[mfi]),
 			  BL_TO_FORTRAN_ANYD((*pml_E[2])[mfi]),
-			  &dtsdx[0], &dtsdx[1], &dtsdx[2]);
+			  &dtsdx[0], &dtsdx[1], &dtsdx[2],
+			  &dt, WRPX_PML_TO_FORTRAN(sigba[mfi]));
         }
-    }
-}
-
-void
-WarpX::DampPML ()
-{
-    for (int lev = 0; lev <= finest_level; ++lev) {
-        DampPML(lev);
-    }
-}
-
-void
-WarpX::DampPML (int lev)
-{
-    DampPML(lev, PatchType::fine);
-    if (lev > 0) DampPML(lev, PatchType::coarse);
-}
-
-void
-WarpX::DampPML (int lev, PatchType patch_type)
-{
-    if (!do_pml) return;
-
-    BL_PROFILE("WarpX::DampPML()");
-
-    if (pml[lev]->ok())
-    {
-        const auto& pml_E = (patch_type == PatchType::fine) ? pml[lev]->GetE_fp() : pml[lev]->GetE_cp();
-        const auto& pml_B = (patch_type == PatchType::fine) ? pml[lev]->GetB_fp() : pml[lev]->GetB_cp();
-        const auto& pml_F = (patch_type == PatchType::fine) ? pml[lev]->GetF_fp() : pml[lev]->GetF_cp();
-        const auto& sigba = (patch_type == PatchType::fine) ? pml[lev]->GetMultiSigmaBox_fp()
-                                                              : pml[lev]->GetMultiSigmaBox_cp();
 
-#ifdef _OPENMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
-#endif
-        for ( MFIter mfi(*pml_E[0], TilingIfNotGPU()); mfi.isValid(); ++mfi )
-        {
-            const Box& tex  = mfi.tilebox(Ex_nodal_flag);
-            const Box& tey  = mfi.tilebox(Ey_nodal_flag);
-            const Box& tez  = mfi.tilebox(Ez_nodal_flag);
-            const Box& tbx  = mfi.tilebox(Bx_nodal_flag);
-            const Box& tby  = mfi.tilebox(By_nodal_flag);
-            const Box& tbz  = mfi.tilebox(Bz_nodal_flag);
-
-            WRPX_DAMP_PML(tex.loVect(), tex.hiVect(),
-			    tey.loVect(), tey.hiVect(),
-			    tez.loVect(), tez.hiVect(),
-			    tbx.loVect(), tbx.hiVect(),
-    			tby.loVect(), tby.hiVect(),
-	    		tbz.loVect(), tbz.hiVect(),
-		    	BL_TO_FORTRAN_3D((*pml_E[0])[mfi]),
-			    BL_TO_FORTRAN_3D((*pml_E[1])[mfi]),
-			    BL_TO_FORTRAN_3D((*pml_E[2])[mfi]),
-			    BL_TO_FORTRAN_3D((*pml_B[0])[mfi]),
-			    BL_TO_FORTRAN_3D((*pml_B[1])[mfi]),
-			    BL_TO_FORTRAN_3D((*pml_B[2])[mfi]),
-			    WRPX_PML_TO_FORTRAN(sigba[mfi]));
-
-            if (pml_F) {
-                const Box& tnd  = mfi.nodaltilebox();
-                WRPX_DAMP_PML_F(tnd.loVect(), tnd.hiVect(),
-			        BL_TO_FORTRAN_3D((*pml_F)[mfi]),
-			        WRPX_PML_TO_FORTRAN(sigba[mfi]));
-            }
-        }
+        if (cpml) pml[lev]->PushMemoryF(patch_type, dt);
     }
 }
 
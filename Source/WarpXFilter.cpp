@@ -0,0 +1,116 @@
+#include <algorithm>
+
+#include <WarpXFilter.H>
+#include <WarpX_f.H>
+
+using namespace amrex;
+
+namespace
+{
+    // Weight of the central point of each 1D pass of the filter
+    Vector<Real> FilterPassWeights (int npass, bool compensation)
+    {
+        Vector<Real> alpha(npass, 0.5);
+        if (compensation) {
+            alpha.push_back(0.5*npass + 1.0);
+        }
+        return alpha;
+    }
+
+    // Filter src, defined on bx grown by the number of passes, into dst on bx.
+    // src and tmp are used as work space for the intermediate passes.
+    void FilterFab (FArrayBox& src, FArrayBox& tmp, FArrayBox& dst, const Box& bx,
+                    int dcomp, int ncomp, const Vector<Real>& alpha)
+    {
+        const int npasses = alpha.size();
+        const int nsteps = npasses*AMREX_SPACEDIM;
+        FArrayBox* work[2] = {&src, &tmp};
+        Box gbx = amrex::grow(bx,npasses);
+        int istep = 0;
+        for (Real a : alpha)
+        {
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim, ++istep)
+            {
+                const FArrayBox& in = *work[istep%2];
+                gbx.grow(idim,-1);
+                if (istep == nsteps-1)
+                {
+                    WRPX_FILTER_1D(BL_TO_FORTRAN_BOX(bx),
+                                   BL_TO_FORTRAN_ANYD(in),
+                                   BL_TO_FORTRAN_N_ANYD(dst,dcomp),
+                                   ncomp, idim, a);
+                }
+                else
+                {
+                    FArrayBox& out = *work[(istep+1)%2];
+                    out.resize(gbx,ncomp);
+                    WRPX_FILTER_1D(BL_TO_FORTRAN_BOX(gbx),
+                                   BL_TO_FORTRAN_ANYD(in),
+                                   BL_TO_FORTRAN_ANYD(out),
+                                   ncomp, idim, a);
+                }
+            }
+        }
+    }
+}
+
+void
+ApplyBinomialFilter (MultiFab& dstmf, const MultiFab& srcmf,
+                     int npass, bool compensation,
+                     int scomp, int dcomp, int ncomp)
+{
+    ncomp = std::min(ncomp, srcmf.nComp());
+    const Vector<Real>& alpha = FilterPassWeights(npass, compensation);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        FArrayBox srcfab, tmpfab;
+        for (MFIter mfi(dstmf,true); mfi.isValid(); ++mfi)
+        {
+            const auto& fab = srcmf[mfi];
+            const Box& tbx = mfi.growntilebox();
+            const Box& gbx = amrex::grow(tbx,static_cast<int>(alpha.size()));
+            srcfab.resize(gbx,ncomp);
+            srcfab.setVal(0.0, gbx, 0, ncomp);
+            const Box& ibx = gbx & fab.box();
+            srcfab.copy(fab, ibx, scomp, ibx, 0, ncomp);
+            FilterFab(srcfab, tmpfab, dstmf[mfi], tbx, dcomp, ncomp, alpha);
+        }
+    }
+}
+
+// Each 1D pass is done in place, line by line, by tiles that span the
+// whole box along the direction of the pass, so that no line is shared by
+// two tiles and no copy of the data is needed.
+void
+ApplyBinomialFilterInPlace (MultiFab& mf, int npass, bool compensation,
+                            int scomp, int ncomp)
+{
+    ncomp = std::min(ncomp, mf.nComp()-scomp);
+    const Vector<Real>& alpha = FilterPassWeights(npass, compensation);
+
+    for (Real a : alpha)
+    {
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+        {
+            MFItInfo info;
+            if (TilingIfNotGPU()) {
+                IntVect tile_size = FabArrayBase::mfiter_tile_size;
+                tile_size[idim] = 1024000;
+                info.EnableTiling(tile_size);
+            }
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            for (MFIter mfi(mf, info); mfi.isValid(); ++mfi)
+            {
+                const Box& tbx = mfi.growntilebox();
+                WRPX_FILTER_1D_INPLACE(BL_TO_FORTRAN_BOX(tbx),
+                                       BL_TO_FORTRAN_N_ANYD(mf[mfi],scomp),
+                                       ncomp, idim, a);
+            }
+        }
+    }
+}
@@ -31,14 +31,20 @@ WarpX::InitData ()
 	PostRestart();
     }
 
-    ComputePMLFactors();
-
     if (WarpX::use_fdtd_nci_corr) {
         WarpX::InitNCICorrector();
     }
 
     BuildBufferMasks();
 
+    // With the cost model, the load can be balanced before the first step
+    if (restart_chkfile.empty() && load_balance_int > 0 && load_balance_with_cost_model) {
+        LoadBalance();
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            costs[lev]->setVal(0.0);
+        }
+    }
+
     InitDiagnostics();
 
     if (ParallelDescriptor::IOProcessor()) {
@@ -105,6 +111,11 @@ WarpX::InitFromScratch ()
     mypc->AllocData();
     mypc->InitData();
 
+    // The particles did not exist when the levels were first tagged
+    if (tag_particle_density > 0.0 && max_level > 0) {
+        Regrid();
+    }
+
 #ifdef USE_OPENBC_POISSON
     InitOpenbc();
 #endif
@@ -124,28 +135,25 @@ WarpX::InitFromScratch ()
 void
 WarpX::InitPML ()
 {
-    if (do_pml)
+    for (int lev = 0; lev <= finest_level; ++lev)
     {
-        pml[0].reset(new PML(boxArray(0), DistributionMap(0), &Geom(0), nullptr,
-                             pml_ncell, pml_delta, 0, do_dive_cleaning, do_moving_window));
-        for (int lev = 1; lev <= finest_level; ++lev)
-        {
-            pml[lev].reset(new PML(boxArray(lev), DistributionMap(lev),
-                                   &Geom(lev), &Geom(lev-1),
-                                   pml_ncell, pml_delta, refRatio(lev-1)[0], do_dive_cleaning,
-                                   do_moving_window));
-        }
+        InitPML(lev, boxArray(lev), DistributionMap(lev));
     }
 }
 
 void
-WarpX::ComputePMLFactors ()
+WarpX::InitPML (int lev, const BoxArray& ba, const DistributionMapping& dm)
 {
     if (do_pml)
     {
-        for (int lev = 0; lev <= finest_level; ++lev)
-        {
-            pml[lev]->ComputePMLFactors(dt[lev]);
+        if (lev == 0) {
+            pml[0].reset(new PML(ba, dm, &Geom(0), nullptr,
+                                 pml_ncell, pml_delta, 0, do_dive_cleaning, do_moving_window,
+                                 pml_type));
+        } else {
+            pml[lev].reset(new PML(ba, dm, &Geom(lev), &Geom(lev-1),
+                                   pml_ncell, pml_delta, refRatio(lev-1)[0], do_dive_cleaning,
+                                   do_moving_window, pml_type));
         }
     }
 }
@@ -1,6 +1,8 @@
 
 #include <WarpX.H>
+#include <WarpX_f.H>
 #include <WarpXConst.H>
+#include <WarpXUtil.H>
 
 using namespace amrex;
 
@@ -12,7 +14,8 @@ WarpX::UpdatePlasmaInjectionPosition (Real dt)
     if (WarpX::do_plasma_injection and (WarpX::gamma_boost > 1)){
         // In boosted-frame simulations, the plasma has moved since the last
         // call to this function, and injection position needs to be updated
-        current_injection_position -= WarpX::beta_boost *
+        // (along with the origin of the plasma lattice)
+        const Real drift = WarpX::beta_boost *
 #if ( AMREX_SPACEDIM == 3 )
             WarpX::boost_direction[dir] * PhysConst::c * dt;
 #elif ( AMREX_SPACEDIM == 2 )
@@ -21,6 +24,8 @@ WarpX::UpdatePlasmaInjectionPosition (Real dt)
             // which has 3 components, for both 2D and 3D simulations.
             WarpX::boost_direction[2*dir] * PhysConst::c * dt;
 #endif
+        current_injection_position -= drift;
+        plasma_lattice_origin -= drift;
     }
 }
 
@@ -43,7 +48,17 @@ WarpX::MoveWindow (bool move_j)
     const Real* cdx = geom[0].CellSize();
     int num_shift_base = static_cast<int>((moving_window_x - current_lo[dir]) / cdx[dir]);
 
-    if (num_shift_base == 0) return 0;
+    if (moving_window_recycle_boxes) {
+        // The grid only moves by whole boxes
+        const int box_length = boxArray(0)[0].length(dir);
+        num_shift_base = (num_shift_base / box_length) * box_length;
+    }
+
+    if (num_shift_base == 0) {
+        // In boosted-frame simulations, the plasma flows in even when the window does not move
+        ContinuousPlasmaInjection();
+        return 0;
+    }
 
     // update the problem domain. Note the we only do this on the base level because
     // amrex::Geometry objects share the same, static RealBox.
@@ -59,139 +74,302 @@ WarpX::MoveWindow (bool move_j)
     int num_shift      = num_shift_base;
     int num_shift_crse = num_shift;
 
-    // Shift the mesh fields
-    for (int lev = 0; lev <= finest_level; ++lev) {
-
-        if (lev > 0) {
-            num_shift_crse = num_shift;
-            num_shift *= refRatio(lev-1)[dir];
-        }
-
-        // Shift each component of vector fields (E, B, j)
-        for (int dim = 0; dim < 3; ++dim) {
+    if (moving_window_recycle_boxes)
+    {
+        // The trailing boxes become the leading boxes, without moving any data
+        RecycleBoxes(num_shift, dir);
+    }
+    else
+    {
+        // Shift the mesh fields
+        for (int lev = 0; lev <= finest_level; ++lev) {
 
-            // Fine grid
-            shiftMF(*Bfield_fp[lev][dim], geom[lev], num_shift, dir);
-            shiftMF(*Efield_fp[lev][dim], geom[lev], num_shift, dir);
-            if (move_j) {
-                shiftMF(*current_fp[lev][dim], geom[lev], num_shift, dir);
-            }
-            if (do_pml && pml[lev]->ok()) {
-                const std::array<MultiFab*, 3>& pml_B = pml[lev]->GetB_fp();
-                const std::array<MultiFab*, 3>& pml_E = pml[lev]->GetE_fp();
-                shiftMF(*pml_B[dim], geom[lev], num_shift, dir);
-                shiftMF(*pml_E[dim], geom[lev], num_shift, dir);
+            if (lev > 0) {
+                num_shift_crse = num_shift;
+                num_shift *= refRatio(lev-1)[dir];
             }
 
-            if (lev > 0) {
-                // Coarse grid
-                shiftMF(*Bfield_cp[lev][dim], geom[lev-1], num_shift_crse, dir);
-                shiftMF(*Efield_cp[lev][dim], geom[lev-1], num_shift_crse, dir);
-                shiftMF(*Bfield_aux[lev][dim], geom[lev], num_shift, dir);
-                shiftMF(*Efield_aux[lev][dim], geom[lev], num_shift, dir);
+            // Shift each component of vector fields (E, B, j)
+            for (int dim = 0; dim < 3; ++dim) {
+
+                // Fine grid
+                shiftMF(*Bfield_fp[lev][dim], geom[lev], num_shift, dir);
+                shiftMF(*Efield_fp[lev][dim], geom[lev], num_shift, dir);
                 if (move_j) {
-                    shiftMF(*current_cp[lev][dim], geom[lev-1], num_shift_crse, dir);
+                    shiftMF(*current_fp[lev][dim], geom[lev], num_shift, dir);
                 }
                 if (do_pml && pml[lev]->ok()) {
-                    const std::array<MultiFab*, 3>& pml_B = pml[lev]->GetB_cp();
-                    const std::array<MultiFab*, 3>& pml_E = pml[lev]->GetE_cp();
-                    shiftMF(*pml_B[dim], geom[lev-1], num_shift_crse, dir);
-                    shiftMF(*pml_E[dim], geom[lev-1], num_shift_crse, dir);
+                    const std::array<MultiFab*, 3>& pml_B = pml[lev]->GetB_fp();
+                    const std::array<MultiFab*, 3>& pml_E = pml[lev]->GetE_fp();
+                    shiftMF(*pml_B[dim], geom[lev], num_shift, dir);
+                    shiftMF(*pml_E[dim], geom[lev], num_shift, dir);
+                }
+
+                if (lev > 0) {
+                    // Coarse grid
+                    shiftMF(*Bfield_cp[lev][dim], geom[lev-1], num_shift_crse, dir);
+                    shiftMF(*Efield_cp[lev][dim], geom[lev-1], num_shift_crse, dir);
+                    shiftMF(*Bfield_aux[lev][dim], geom[lev], num_shift, dir);
+                    shiftMF(*Efield_aux[lev][dim], geom[lev], num_shift, dir);
+                    if (move_j) {
+                        shiftMF(*current_cp[lev][dim], geom[lev-1], num_shift_crse, dir);
+                    }
+                    if (do_pml && pml[lev]->ok()) {
+                        const std::array<MultiFab*, 3>& pml_B = pml[lev]->GetB_cp();
+                        const std::array<MultiFab*, 3>& pml_E = pml[lev]->GetE_cp();
+                        shiftMF(*pml_B[dim], geom[lev-1], num_shift_crse, dir);
+                        shiftMF(*pml_E[dim], geom[lev-1], num_shift_crse, dir);
+                    }
                 }
             }
-        }
 
-        // Shift scalar component F for dive cleaning
-        if (do_dive_cleaning) {
-            // Fine grid
-            shiftMF(*F_fp[lev],   geom[lev], num_shift, dir);
+            // Shift the memory variables of the convolutional PML
             if (do_pml && pml[lev]->ok()) {
-                MultiFab* pml_F = pml[lev]->GetF_fp();
-                shiftMF(*pml_F, geom[lev], num_shift, dir);
-            }
-            if (lev > 0) {
-                // Coarse grid
-                shiftMF(*F_cp[lev], geom[lev-1], num_shift_crse, dir);
-                if (do_pml && pml[lev]->ok()) {
-                    MultiFab* pml_F = pml[lev]->GetF_cp();
-                    shiftMF(*pml_F, geom[lev-1], num_shift_crse, dir);
+                for (MultiFab* psi : pml[lev]->GetMemoryVars(PatchType::fine)) {
+                    shiftMF(*psi, geom[lev], num_shift, dir);
+                }
+                if (lev > 0) {
+                    for (MultiFab* psi : pml[lev]->GetMemoryVars(PatchType::coarse)) {
+                        shiftMF(*psi, geom[lev-1], num_shift_crse, dir);
+                    }
                 }
-                shiftMF(*rho_cp[lev], geom[lev-1], num_shift_crse, dir);
             }
-        }
 
-        // Shift scalar component rho
-        if (move_j) {
-            if (rho_fp[lev]){
+            // Shift scalar component F for dive cleaning
+            if (do_dive_cleaning) {
                 // Fine grid
-                shiftMF(*rho_fp[lev],   geom[lev], num_shift, dir);
-                if (lev > 0){
+                shiftMF(*F_fp[lev],   geom[lev], num_shift, dir);
+                if (do_pml && pml[lev]->ok()) {
+                    MultiFab* pml_F = pml[lev]->GetF_fp();
+                    shiftMF(*pml_F, geom[lev], num_shift, dir);
+                }
+                if (lev > 0) {
                     // Coarse grid
+                    shiftMF(*F_cp[lev], geom[lev-1], num_shift_crse, dir);
+                    if (do_pml && pml[lev]->ok()) {
+                        MultiFab* pml_F = pml[lev]->GetF_cp();
+                        shiftMF(*pml_F, geom[lev-1], num_shift_crse, dir);
+                    }
                     shiftMF(*rho_cp[lev], geom[lev-1], num_shift_crse, dir);
                 }
             }
+
+            // Shift scalar component rho
+            if (move_j) {
+                if (rho_fp[lev]){
+                    // Fine grid
+                    shiftMF(*rho_fp[lev],   geom[lev], num_shift, dir);
+                    if (lev > 0){
+                        // Coarse grid
+                        shiftMF(*rho_cp[lev], geom[lev-1], num_shift_crse, dir);
+                    }
+                }
+            }
         }
     }
 
-    // Continuously inject plasma in new cells (by default only on level 0)
-    if (WarpX::do_plasma_injection) {
-
-        const int lev = 0;
-
-        // particleBox encloses the cells where we generate particles
-        // (only injects particles in an integer number of cells,
-        // for correct particle spacing)
-        RealBox particleBox = geom[lev].ProbDomain();
-        Real new_injection_position;
-        if (moving_window_v >= 0){
-            // Forward-moving window
-            Real dx = geom[lev].CellSize(dir);
-            new_injection_position = current_injection_position +
-                std::floor( (geom[lev].ProbHi(dir) - current_injection_position)/dx ) * dx;
-        } else {
-            // Backward-moving window
-            Real dx = geom[lev].CellSize(dir);
-            new_injection_position = current_injection_position -
-                std::floor( (current_injection_position - geom[lev].ProbLo(dir))/dx) * dx;
+    ContinuousPlasmaInjection();
+
+    return num_shift_base;
+}
+
+/* \brief Inject the plasma that entered the domain since the last call
+ * (by default only on level 0).
+ *
+ * The slab between the injection front and the edge of the domain is filled
+ * at every step. In boosted-frame simulations, this slab is the inflow of
+ * plasma during one step, which is usually thinner than a cell: the particles
+ * of the cells that are only partly inside the slab are generated on the
+ * lattice of the plasma (anchored at current_injection_position), and only
+ * those inside the slab are kept. The remaining part of the cell is filled at
+ * the next steps, from the same random draws (the cells are keyed by their
+ * index on the plasma lattice, see PhysicalParticleContainer::InjectionCellKey),
+ * so that every cell ends up with exactly its number of particles. Only the ranks that own the boxes at the leading edge of the
+ * domain do any work.
+ */
+void
+WarpX::ContinuousPlasmaInjection ()
+{
+    if (not WarpX::do_plasma_injection) return;
+
+    const int lev = 0;
+    const int dir = moving_window_dir;
+    const Real dx = geom[lev].CellSize(dir);
+
+    // particleBox encloses the cells where we generate particles
+    // (only injects particles in an integer number of cells,
+    // for correct particle spacing), and slabBox the part of
+    // these cells that has not been filled yet
+    RealBox particleBox = geom[lev].ProbDomain();
+    RealBox slabBox = geom[lev].ProbDomain();
+    Real new_injection_position;
+    if (moving_window_v >= 0){
+        // Forward-moving window
+        const Real width = geom[lev].ProbHi(dir) - current_injection_position;
+        if (width <= current_injection_offset) return;
+        new_injection_position = current_injection_position + std::floor(width/dx) * dx;
+        particleBox.setLo( dir, current_injection_position );
+        particleBox.setHi( dir, current_injection_position + std::ceil(width/dx) * dx );
+        slabBox.setLo( dir, current_injection_position + current_injection_offset );
+        current_injection_offset = geom[lev].ProbHi(dir) - new_injection_position;
+    } else {
+        // Backward-moving window
+        const Real width = current_injection_position - geom[lev].ProbLo(dir);
+        if (width <= current_injection_offset) return;
+        new_injection_position = current_injection_position - std::floor(width/dx) * dx;
+        particleBox.setLo( dir, current_injection_position - std::ceil(width/dx) * dx );
+        particleBox.setHi( dir, current_injection_position );
+        slabBox.setHi( dir, current_injection_position - current_injection_offset );
+        current_injection_offset = new_injection_position - geom[lev].ProbLo(dir);
+    }
+    current_injection_position = new_injection_position;
+
+    // Only the ranks that own a box intersecting the slab inject particles
+    const Real* problo = geom[lev].ProbLo();
+    Box slab_box = geom[lev].Domain();
+    slab_box.setSmall( dir, static_cast<int>(std::floor((slabBox.lo(dir)-problo[dir])/dx)) );
+    slab_box.setBig( dir, static_cast<int>(std::ceil((slabBox.hi(dir)-problo[dir])/dx)) - 1 );
+    bool owns_slab = false;
+    for (const auto& is : boxArray(lev).intersections(slab_box)) {
+        if (DistributionMap(lev)[is.first] == ParallelDescriptor::MyProc()) {
+            owns_slab = true;
+            break;
         }
-        // Modify the corresponding bounds of the particleBox
-        if (moving_window_v >= 0) {
-            particleBox.setLo( dir, current_injection_position );
-            particleBox.setHi( dir, new_injection_position );
-        } else {
-            particleBox.setLo( dir, new_injection_position );
-            particleBox.setHi( dir, current_injection_position );
+    }
+    if (not owns_slab) return;
+
+    // Perform the injection of new particles in slabBox
+    for (int i = 0; i < num_injected_species; ++i) {
+        int ispecies = injected_plasma_species[i];
+        WarpXParticleContainer& pc = mypc->GetParticleContainer(ispecies);
+        auto& ppc = dynamic_cast<PhysicalParticleContainer&>(pc);
+        ppc.AddPlasma(lev, particleBox, slabBox);
+    }
+}
+
+namespace
+{
+    // Shift the data of mf by any number of cells along dir, by copying it
+    // from an alias of itself whose boxes are shifted by -num_shift.
+    void ShiftMFByCopy (MultiFab& mf, const Periodicity& period, int num_shift, int dir)
+    {
+        const int nc = mf.nComp();
+        const IntVect& ng = mf.nGrowVect();
+
+        MultiFab view(amrex::shift(mf.boxArray(), dir, -num_shift), mf.DistributionMap(),
+                      nc, ng, MFInfo().SetAlloc(false));
+        for (MFIter mfi(view); mfi.isValid(); ++mfi) {
+            std::unique_ptr<FArrayBox> fab(new FArrayBox(mf[mfi], amrex::make_alias, 0, nc));
+            fab->shift(dir, -num_shift);
+            view.setFab(mfi, std::move(fab));
         }
-        // Perform the injection of new particles in particleBox
-        if (particleBox.ok() and (current_injection_position != new_injection_position)){
-            for (int i = 0; i < num_injected_species; ++i) {
-                int ispecies = injected_plasma_species[i];
-                WarpXParticleContainer& pc = mypc->GetParticleContainer(ispecies);
-                auto& ppc = dynamic_cast<PhysicalParticleContainer&>(pc);
-                ppc.AddPlasma(lev, particleBox);
-            }
-            // Update the injection position
-            current_injection_position = new_injection_position;
+
+        MultiFab tmp(mf.boxArray(), mf.DistributionMap(), nc, ng);
+        tmp.setVal(0.0);
+        tmp.ParallelCopy(view, 0, 0, nc, IntVect::TheZeroVector(), ng, period);
+        MultiFab::Copy(mf, tmp, 0, 0, nc, ng);
+    }
+}
+
+/* \brief Move the fields of level 0 by num_shift cells along dir, where num_shift
+ * is a multiple of the length of the boxes along dir.
+ *
+ * Instead of shifting the data within each box, the fab of the box num_shift
+ * cells ahead is relabeled as the fab of each box, and the DistributionMapping
+ * follows the data. The boxes that the window leaves are set to zero and
+ * reused for the region that the window moves into. Only the (small) PML
+ * data is copied.
+ */
+void
+WarpX::RecycleBoxes (int num_shift, int dir)
+{
+    BL_PROFILE("WarpX::RecycleBoxes()");
+
+    const int lev = 0;
+    const BoxArray& ba = boxArray(lev);
+    const DistributionMapping& old_dm = DistributionMap(lev);
+    const Box& domain = Geom(lev).Domain();
+    const int nboxes = ba.size();
+
+    // Source of the data of each box, and new owner
+    Vector<int> src(nboxes), is_new(nboxes, 0), pmap(nboxes);
+    for (int i = 0; i < nboxes; ++i)
+    {
+        Box b = amrex::shift(ba[i], dir, num_shift);
+        if (!domain.contains(b)) {
+            b.shift(dir, (num_shift > 0) ? -domain.length(dir) : domain.length(dir));
+            is_new[i] = 1;
         }
+        const auto& isects = ba.intersections(b);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(isects.size() == 1 && ba[isects[0].first] == b,
+            "warpx.moving_window_recycle_boxes requires boxes of the same length "
+            "along the moving direction");
+        src[i] = isects[0].first;
+        pmap[i] = old_dm[src[i]];
     }
+    const DistributionMapping dm(std::move(pmap));
 
-    return num_shift_base;
+    for (int idim = 0; idim < 3; ++idim) {
+        RecycleFabArray<FArrayBox>(Efield_fp[lev][idim], dm, src, is_new, dir);
+        RecycleFabArray<FArrayBox>(Bfield_fp[lev][idim], dm, src, is_new, dir);
+        RecycleFabArray<FArrayBox>(current_fp[lev][idim], dm, src, is_new, dir);
+        RecycleFabArray<FArrayBox>(current_store[lev][idim], dm, src, is_new, dir);
+    }
+    RecycleFabArray<FArrayBox>(F_fp[lev], dm, src, is_new, dir);
+    RecycleFabArray<FArrayBox>(rho_fp[lev], dm, src, is_new, dir);
+    RecycleFabArray<FArrayBox>(costs[lev], dm, src, is_new, dir);
+
+    // The owner masks depend on the position of each box
+    const auto& period = Geom(lev).periodicity();
+    for (int idim = 0; idim < 3; ++idim) {
+        current_fp_owner_masks[lev][idim] = std::move(current_fp[lev][idim]->OwnerMask(period));
+    }
+    if (rho_fp[lev]) {
+        rho_fp_owner_masks[lev] = std::move(rho_fp[lev]->OwnerMask(period));
+    }
+
+    for (int idim = 0; idim < 3; ++idim) {
+        Bfield_aux[lev][idim].reset(new MultiFab(*Bfield_fp[lev][idim], amrex::make_alias, 0, 1));
+        Efield_aux[lev][idim].reset(new MultiFab(*Efield_fp[lev][idim], amrex::make_alias, 0, 1));
+    }
+
+    SetDistributionMap(lev, dm);
+
+    if (do_pml && pml[lev]->ok())
+    {
+        for (MultiFab* mf : pml[lev]->GetE_fp()) ShiftMFByCopy(*mf, period, num_shift, dir);
+        for (MultiFab* mf : pml[lev]->GetB_fp()) ShiftMFByCopy(*mf, period, num_shift, dir);
+        if (pml[lev]->GetF_fp()) ShiftMFByCopy(*pml[lev]->GetF_fp(), period, num_shift, dir);
+        for (MultiFab* psi : pml[lev]->GetMemoryVars(PatchType::fine)) {
+            ShiftMFByCopy(*psi, period, num_shift, dir);
+        }
+        pml[lev]->ChangeDistributionMap(ba, dm);
+    }
+
+    // Guard cells next to the recycled boxes
+    FillBoundaryE();
+    FillBoundaryB();
+    if (do_dive_cleaning) FillBoundaryF();
 }
 
+/* \brief Shift the data of mf by num_shift cells along dir, when the window moves.
+ *
+ * The data is moved in place: the ghost cells are first filled with the data
+ * of the neighboring boxes (which needs as many ghost cells as shifted cells),
+ * then each fab is shifted within its own memory. The cells that the window
+ * moved into are set to zero; the data of the cells that it left is discarded.
+ */
 void
 WarpX::shiftMF (MultiFab& mf, const Geometry& geom, int num_shift, int dir)
 {
     BL_PROFILE("WarpX::shiftMF()");
     const BoxArray& ba = mf.boxArray();
-    const DistributionMapping& dm = mf.DistributionMap();
     const int nc = mf.nComp();
     const IntVect& ng = mf.nGrowVect();
 
-    AMREX_ALWAYS_ASSERT(ng.min() >= num_shift);
+    AMREX_ALWAYS_ASSERT(ng.min() >= std::abs(num_shift));
 
-    MultiFab tmpmf(ba, dm, nc, ng);
-    MultiFab::Copy(tmpmf, mf, 0, 0, nc, ng);
-    tmpmf.FillBoundary(geom.periodicity());
+    mf.FillBoundary(geom.periodicity());
 
     // Make a box that covers the region that the window moved into
     const IndexType& typ = ba.ixType();
@@ -220,26 +398,21 @@ WarpX::shiftMF (MultiFab& mf, const Geometry& geom, int num_shift, int dir)
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-    for (MFIter mfi(tmpmf); mfi.isValid(); ++mfi )
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi )
     {
-      FArrayBox* dstfab = mf.fabPtr(mfi);
-      FArrayBox* srcfab = tmpmf.fabPtr(mfi);
-      Box outbox = mfi.fabbox();
-      outbox &= adjBox;
-      AMREX_LAUNCH_HOST_DEVICE_LAMBDA(outbox, toutbox,
-      {
-	srcfab->setVal(0.0, toutbox, 0, nc);
-      });
-      Box dstBox = mf[mfi].box();
-      if (num_shift > 0) {
-	dstBox.growHi(dir, -num_shift);
-      } else {
-	dstBox.growLo(dir,  num_shift);
-      }
-      AMREX_LAUNCH_HOST_DEVICE_LAMBDA(dstBox, tdstBox,
-      {
-        dstfab->setVal(0.0, tdstBox, 0, nc);
-        dstfab->copy(*srcfab, amrex::shift(tdstBox,dir,num_shift), 0, tdstBox, 0, nc);
-      });
+        FArrayBox& fab = mf[mfi];
+        const Box& outbox = mfi.fabbox() & adjBox;
+        if (outbox.ok()) {
+            fab.setVal(0.0, outbox, 0, nc);
+        }
+        Box dstBox = fab.box();
+        if (num_shift > 0) {
+            dstBox.growHi(dir, -num_shift);
+        } else {
+            dstBox.growLo(dir,  num_shift);
+        }
+        warpx_shift_in_place(BL_TO_FORTRAN_BOX(dstBox),
+                             BL_TO_FORTRAN_ANYD(fab),
+                             nc, dir, num_shift);
     }
 }
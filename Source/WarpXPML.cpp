@@ -2,11 +2,16 @@
 #include <WarpXPML.H>
 #include <WarpX.H>
 #include <WarpXConst.H>
+#include <WarpX_f.H>
+#include <WarpXUtil.H>
 
 #include <AMReX_Print.H>
 #include <AMReX_VisMF.H>
+#include <AMReX_Utility.H>
 
 #include <algorithm>
+#include <fstream>
+#include <sstream>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -65,6 +70,32 @@ namespace
         std::fill(sigma.begin()+(olo-slo), sigma.begin()+(ohi+2-slo), 0.0);
         std::fill(sigma_star.begin()+(olo-sslo), sigma_star.begin()+(ohi+1-sslo), 0.0);
     }
+
+    static void RedistributeMF (std::unique_ptr<MultiFab>& mf, const DistributionMapping& dm)
+    {
+        RemapFabArray<FArrayBox>(mf, dm, true);
+    }
+
+    // Distribution map of a subset of the boxes of a BoxArray
+    static DistributionMapping SubsetDistributionMap (const Vector<int>& ids,
+                                                      const DistributionMapping& dm)
+    {
+        Vector<int> pmap(ids.size());
+        for (int i = 0, N = ids.size(); i < N; ++i) {
+            pmap[i] = dm[ids[i]];
+        }
+        return DistributionMapping(std::move(pmap));
+    }
+
+    // Component of the field along the idim-th PML direction
+    static int PhysicalDirection (int idim)
+    {
+#if (AMREX_SPACEDIM == 3)
+        return idim;
+#else
+        return 2*idim;
+#endif
+    }
 }
 
 SigmaBox::SigmaBox (const Box& box, const BoxArray& grids, const Real* dx, int ncell, int delta)
@@ -79,17 +110,11 @@ SigmaBox::SigmaBox (const Box& box, const BoxArray& grids, const Real* dx, int n
     {
         sigma         [idim].resize(sz[idim]+1);
         sigma_star    [idim].resize(sz[idim]  );
-        sigma_fac     [idim].resize(sz[idim]+1);
-        sigma_star_fac[idim].resize(sz[idim]  );
 
         sigma         [idim].m_lo = lo[idim];
         sigma         [idim].m_hi = hi[idim]+1;
         sigma_star    [idim].m_lo = lo[idim];
         sigma_star    [idim].m_hi = hi[idim];
-        sigma_fac     [idim].m_lo = lo[idim];
-        sigma_fac     [idim].m_hi = hi[idim]+1;
-        sigma_star_fac[idim].m_lo = lo[idim];
-        sigma_star_fac[idim].m_hi = hi[idim];
     }
 
     Array<Real,AMREX_SPACEDIM> fac;
@@ -251,87 +276,22 @@ SigmaBox::SigmaBox (const Box& box, const BoxArray& grids, const Real* dx, int n
     }
 }
 
-void
-SigmaBox::ComputePMLFactorsB (const Real* dx, Real dt)
-{
-    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
-    {
-        for (int i = 0, N = sigma_star[idim].size(); i < N; ++i)
-        {
-            if (sigma_star[idim][i] == 0.0)
-            {
-                sigma_star_fac[idim][i] = 1.0;
-            }
-            else
-            {
-                sigma_star_fac[idim][i] = std::exp(-sigma_star[idim][i]*dt);
-            }
-        }
-    }
-}
-
-void
-SigmaBox::ComputePMLFactorsE (const Real* dx, Real dt)
-{
-    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
-    {
-        for (int i = 0, N = sigma[idim].size(); i < N; ++i)
-        {
-            if (sigma[idim][i] == 0.0)
-            {
-                sigma_fac[idim][i] = 1.0;
-            }
-            else
-            {
-                sigma_fac[idim][i] = std::exp(-sigma[idim][i]*dt);
-            }
-        }
-    }
-}
-
 MultiSigmaBox::MultiSigmaBox (const BoxArray& ba, const DistributionMapping& dm,
                               const BoxArray& grid_ba, const Real* dx, int ncell, int delta)
     : FabArray<SigmaBox>(ba,dm,1,0,MFInfo(),
                          FabFactory<SigmaBox>(grid_ba,dx,ncell,delta))
 {}
 
-void
-MultiSigmaBox::ComputePMLFactorsB (const Real* dx, Real dt)
-{
-    if (dt == dt_B) return;
-
-    dt_B = dt;
-
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-    for (MFIter mfi(*this); mfi.isValid(); ++mfi)
-    {
-        (*this)[mfi].ComputePMLFactorsB(dx, dt);
-    }
-}
-
-void
-MultiSigmaBox::ComputePMLFactorsE (const Real* dx, Real dt)
-{
-    if (dt == dt_E) return;
-
-    dt_E = dt;
-
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-    for (MFIter mfi(*this); mfi.isValid(); ++mfi)
-    {
-        (*this)[mfi].ComputePMLFactorsE(dx, dt);
-    }
-}
-
 PML::PML (const BoxArray& grid_ba, const DistributionMapping& grid_dm,
           const Geometry* geom, const Geometry* cgeom,
-          int ncell, int delta, int ref_ratio, int do_dive_cleaning, int do_moving_window)
-    : m_geom(geom),
-      m_cgeom(cgeom)
+          int ncell, int delta, int ref_ratio, int do_dive_cleaning, int do_moving_window,
+          PMLType pml_type)
+    : m_type(pml_type),
+      m_geom(geom),
+      m_cgeom(cgeom),
+      m_ncell(ncell),
+      m_delta(delta),
+      m_ref_ratio(ref_ratio)
 {
     const BoxArray& ba = MakeBoxArray(*geom, grid_ba, ncell);
     if (ba.size() == 0) {
@@ -341,19 +301,25 @@ PML::PML (const BoxArray& grid_ba, const DistributionMapping& grid_dm,
         m_ok = true;
     }
 
-    DistributionMapping dm{ba};
+    const DistributionMapping& dm = MakeDistributionMap(ba, grid_ba, grid_dm);
 
     int nge = 2;
     int ngb = 2;
     int ngf = (do_moving_window) ? 2 : 0;
     if (WarpX::maxwell_fdtd_solver_id == 1) ngf = std::max( ngf, 1 );
+    const int ngpsi = (do_moving_window) ? 2 : 0;
+
+    const bool split = (m_type == PMLType::Split);
+    const int ncompe = (split) ? 3 : 1;
+    const int ncompb = (split) ? 2 : 1;
+    const int ncompf = (split) ? 3 : 1;
 
-    pml_E_fp[0].reset(new MultiFab(amrex::convert(ba,WarpX::Ex_nodal_flag), dm, 3, nge));
-    pml_E_fp[1].reset(new MultiFab(amrex::convert(ba,WarpX::Ey_nodal_flag), dm, 3, nge));
-    pml_E_fp[2].reset(new MultiFab(amrex::convert(ba,WarpX::Ez_nodal_flag), dm, 3, nge));
-    pml_B_fp[0].reset(new MultiFab(amrex::convert(ba,WarpX::Bx_nodal_flag), dm, 2, ngb));
-    pml_B_fp[1].reset(new MultiFab(amrex::convert(ba,WarpX::By_nodal_flag), dm, 2, ngb));
-    pml_B_fp[2].reset(new MultiFab(amrex::convert(ba,WarpX::Bz_nodal_flag), dm, 2, ngb));
+    pml_E_fp[0].reset(new MultiFab(amrex::convert(ba,WarpX::Ex_nodal_flag), dm, ncompe, nge));
+    pml_E_fp[1].reset(new MultiFab(amrex::convert(ba,WarpX::Ey_nodal_flag), dm, ncompe, nge));
+    pml_E_fp[2].reset(new MultiFab(amrex::convert(ba,WarpX::Ez_nodal_flag), dm, ncompe, nge));
+    pml_B_fp[0].reset(new MultiFab(amrex::convert(ba,WarpX::Bx_nodal_flag), dm, ncompb, ngb));
+    pml_B_fp[1].reset(new MultiFab(amrex::convert(ba,WarpX::By_nodal_flag), dm, ncompb, ngb));
+    pml_B_fp[2].reset(new MultiFab(amrex::convert(ba,WarpX::Bz_nodal_flag), dm, ncompb, ngb));
 
     pml_E_fp[0]->setVal(0.0);
     pml_E_fp[1]->setVal(0.0);
@@ -364,12 +330,16 @@ PML::PML (const BoxArray& grid_ba, const DistributionMapping& grid_dm,
 
     if (do_dive_cleaning)
     {
-        pml_F_fp.reset(new MultiFab(amrex::convert(ba,IntVect::TheUnitVector()), dm, 3, ngf));
+        pml_F_fp.reset(new MultiFab(amrex::convert(ba,IntVect::TheUnitVector()), dm, ncompf, ngf));
         pml_F_fp->setVal(0.0);
     }
 
     sigba_fp.reset(new MultiSigmaBox(ba, dm, grid_ba, geom->CellSize(), ncell, delta));
 
+    if (m_type == PMLType::Convolutional) {
+        MakeMemoryVars(PatchType::fine, ngpsi);
+    }
+
     if (cgeom)
     {
 
@@ -380,14 +350,14 @@ PML::PML (const BoxArray& grid_ba, const DistributionMapping& grid_dm,
         grid_cba.coarsen(ref_ratio);
         const BoxArray& cba = MakeBoxArray(*cgeom, grid_cba, ncell);
 
-        DistributionMapping cdm{cba};
+        const DistributionMapping& cdm = MakeDistributionMap(cba, grid_cba, grid_dm);
 
-        pml_E_cp[0].reset(new MultiFab(amrex::convert(cba,WarpX::Ex_nodal_flag), cdm, 3, nge));
-        pml_E_cp[1].reset(new MultiFab(amrex::convert(cba,WarpX::Ey_nodal_flag), cdm, 3, nge));
-        pml_E_cp[2].reset(new MultiFab(amrex::convert(cba,WarpX::Ez_nodal_flag), cdm, 3, nge));
-        pml_B_cp[0].reset(new MultiFab(amrex::convert(cba,WarpX::Bx_nodal_flag), cdm, 2, ngb));
-        pml_B_cp[1].reset(new MultiFab(amrex::convert(cba,WarpX::By_nodal_flag), cdm, 2, ngb));
-        pml_B_cp[2].reset(new MultiFab(amrex::convert(cba,WarpX::Bz_nodal_flag), cdm, 2, ngb));
+        pml_E_cp[0].reset(new MultiFab(amrex::convert(cba,WarpX::Ex_nodal_flag), cdm, ncompe, nge));
+        pml_E_cp[1].reset(new MultiFab(amrex::convert(cba,WarpX::Ey_nodal_flag), cdm, ncompe, nge));
+        pml_E_cp[2].reset(new MultiFab(amrex::convert(cba,WarpX::Ez_nodal_flag), cdm, ncompe, nge));
+        pml_B_cp[0].reset(new MultiFab(amrex::convert(cba,WarpX::Bx_nodal_flag), cdm, ncompb, ngb));
+        pml_B_cp[1].reset(new MultiFab(amrex::convert(cba,WarpX::By_nodal_flag), cdm, ncompb, ngb));
+        pml_B_cp[2].reset(new MultiFab(amrex::convert(cba,WarpX::Bz_nodal_flag), cdm, ncompb, ngb));
 
         pml_E_cp[0]->setVal(0.0);
         pml_E_cp[1]->setVal(0.0);
@@ -398,11 +368,15 @@ PML::PML (const BoxArray& grid_ba, const DistributionMapping& grid_dm,
 
         if (do_dive_cleaning)
         {
-            pml_F_cp.reset(new MultiFab(amrex::convert(cba,IntVect::TheUnitVector()), cdm, 3, ngf));
+            pml_F_cp.reset(new MultiFab(amrex::convert(cba,IntVect::TheUnitVector()), cdm, ncompf, ngf));
             pml_F_cp->setVal(0.0);
         }
 
         sigba_cp.reset(new MultiSigmaBox(cba, cdm, grid_cba, cgeom->CellSize(), ncell, delta));
+
+        if (m_type == PMLType::Convolutional) {
+            MakeMemoryVars(PatchType::coarse, ngpsi);
+        }
     }
 
 }
@@ -467,16 +441,335 @@ PML::MakeBoxArray (const amrex::Geometry& geom, const amrex::BoxArray& grid_ba,
     return ba;
 }
 
+/* \brief Assign each PML box to the rank that owns the grid box it is in
+ * contact with (largest contact area wins), so that the exchanges between
+ * the PML and the regular grids are mostly rank-local copies.
+ */
+DistributionMapping
+PML::MakeDistributionMap (const BoxArray& ba, const BoxArray& grid_ba,
+                          const DistributionMapping& grid_dm)
+{
+    const int nprocs = ParallelDescriptor::NProcs();
+    Vector<int> pmap(ba.size());
+    for (int i = 0, N = ba.size(); i < N; ++i)
+    {
+        // Box with no neighbor (should not happen): fall back to round robin.
+        int owner = i % nprocs;
+        long npts = 0;
+        const auto& isects = grid_ba.intersections(amrex::grow(ba[i],1));
+        for (const auto& kv : isects)
+        {
+            if (kv.second.numPts() > npts) {
+                npts = kv.second.numPts();
+                owner = grid_dm[kv.first];
+            }
+        }
+        pmap[i] = owner;
+    }
+    return DistributionMapping(std::move(pmap));
+}
+
+void
+PML::ChangeDistributionMap (const BoxArray& grid_ba, const DistributionMapping& grid_dm)
+{
+    if (!m_ok) return;
+
+    {
+        const BoxArray& ba = sigba_fp->boxArray();
+        const DistributionMapping& dm = MakeDistributionMap(ba, grid_ba, grid_dm);
+        if (dm != sigba_fp->DistributionMap())
+        {
+            for (int idim = 0; idim < 3; ++idim) {
+                RedistributeMF(pml_E_fp[idim], dm);
+                RedistributeMF(pml_B_fp[idim], dm);
+            }
+            RedistributeMF(pml_F_fp, dm);
+            sigba_fp.reset(new MultiSigmaBox(ba, dm, grid_ba, m_geom->CellSize(), m_ncell, m_delta));
+            RedistributeMemoryVars(PatchType::fine);
+        }
+    }
+
+    if (sigba_cp)
+    {
+        BoxArray grid_cba = grid_ba;
+        grid_cba.coarsen(m_ref_ratio);
+        const BoxArray& cba = sigba_cp->boxArray();
+        const DistributionMapping& cdm = MakeDistributionMap(cba, grid_cba, grid_dm);
+        if (cdm != sigba_cp->DistributionMap())
+        {
+            for (int idim = 0; idim < 3; ++idim) {
+                RedistributeMF(pml_E_cp[idim], cdm);
+                RedistributeMF(pml_B_cp[idim], cdm);
+            }
+            RedistributeMF(pml_F_cp, cdm);
+            sigba_cp.reset(new MultiSigmaBox(cba, cdm, grid_cba, m_cgeom->CellSize(), m_ncell, m_delta));
+            RedistributeMemoryVars(PatchType::coarse);
+        }
+    }
+}
+
+void
+PML::CopyFrom (const PML& src)
+{
+    if (!m_ok || !src.ok()) return;
+
+    auto copy = [] (std::unique_ptr<MultiFab>& dst, const std::unique_ptr<MultiFab>& s,
+                    const Geometry* geom) {
+        if (dst && s) {
+            dst->ParallelCopy(*s, 0, 0, dst->nComp(), IntVect::TheZeroVector(),
+                              dst->nGrowVect(), geom->periodicity());
+        }
+    };
+
+    for (int idim = 0; idim < 3; ++idim) {
+        copy(pml_E_fp[idim], src.pml_E_fp[idim], m_geom);
+        copy(pml_B_fp[idim], src.pml_B_fp[idim], m_geom);
+        copy(pml_E_cp[idim], src.pml_E_cp[idim], m_cgeom);
+        copy(pml_B_cp[idim], src.pml_B_cp[idim], m_cgeom);
+    }
+    copy(pml_F_fp, src.pml_F_fp, m_geom);
+    copy(pml_F_cp, src.pml_F_cp, m_cgeom);
+
+    // The memory variables along idim cover the PML boxes with a nonzero
+    // sigma along idim, which is the same region for both PMLs.
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        for (int icomp = 0; icomp < 3; ++icomp) {
+            copy(psi_E_fp[idim][icomp], src.psi_E_fp[idim][icomp], m_geom);
+            copy(psi_B_fp[idim][icomp], src.psi_B_fp[idim][icomp], m_geom);
+            copy(psi_E_cp[idim][icomp], src.psi_E_cp[idim][icomp], m_cgeom);
+            copy(psi_B_cp[idim][icomp], src.psi_B_cp[idim][icomp], m_cgeom);
+        }
+        copy(psi_F_fp[idim], src.psi_F_fp[idim], m_geom);
+        copy(psi_F_cp[idim], src.psi_F_cp[idim], m_cgeom);
+    }
+}
+
 void
-PML::ComputePMLFactors (amrex::Real dt)
+PML::MakeMemoryVars (PatchType patch_type, int ngpsi)
 {
-    if (sigba_fp) {
-        sigba_fp->ComputePMLFactorsB(m_geom->CellSize(), dt);
-        sigba_fp->ComputePMLFactorsE(m_geom->CellSize(), dt);
+    const bool fine = (patch_type == PatchType::fine);
+    const MultiSigmaBox& sigba = (fine) ? *sigba_fp : *sigba_cp;
+    const bool has_F = (fine) ? bool(pml_F_fp) : bool(pml_F_cp);
+    auto& psi_box = (fine) ? psi_box_fp : psi_box_cp;
+    auto& psi_E   = (fine) ? psi_E_fp   : psi_E_cp;
+    auto& psi_B   = (fine) ? psi_B_fp   : psi_B_cp;
+    auto& psi_F   = (fine) ? psi_F_fp   : psi_F_cp;
+
+    const BoxArray& ba = sigba.boxArray();
+    const DistributionMapping& dm = sigba.DistributionMap();
+    const int nboxes = ba.size();
+
+    const std::array<IntVect,3> E_nodal_flag
+        {WarpX::Ex_nodal_flag, WarpX::Ey_nodal_flag, WarpX::Ez_nodal_flag};
+    const std::array<IntVect,3> B_nodal_flag
+        {WarpX::Bx_nodal_flag, WarpX::By_nodal_flag, WarpX::Bz_nodal_flag};
+
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        // Flag the PML boxes that have a nonzero conductivity along idim
+        Vector<int> flag(nboxes, 0);
+        for (MFIter mfi(sigba); mfi.isValid(); ++mfi)
+        {
+            const SigmaBox& sb = sigba[mfi];
+            auto nonzero = [] (Real x) { return x != 0.0; };
+            if (std::any_of(sb.sigma[idim].begin(), sb.sigma[idim].end(), nonzero) ||
+                std::any_of(sb.sigma_star[idim].begin(), sb.sigma_star[idim].end(), nonzero))
+            {
+                flag[mfi.index()] = 1;
+            }
+        }
+        ParallelDescriptor::ReduceIntMax(flag.data(), nboxes);
+
+        psi_box[idim].clear();
+        BoxList bl;
+        for (int i = 0; i < nboxes; ++i) {
+            if (flag[i]) {
+                psi_box[idim].push_back(i);
+                bl.push_back(ba[i]);
+            }
+        }
+        if (psi_box[idim].empty()) continue;
+
+        const BoxArray psi_ba(std::move(bl));
+        const DistributionMapping& psi_dm = SubsetDistributionMap(psi_box[idim], dm);
+
+        const int pd = PhysicalDirection(idim);
+        for (int icomp = 0; icomp < 3; ++icomp)
+        {
+            if (icomp != pd) {
+                psi_B[idim][icomp].reset(new MultiFab(amrex::convert(psi_ba,B_nodal_flag[icomp]),
+                                                      psi_dm, 1, ngpsi));
+                psi_B[idim][icomp]->setVal(0.0);
+            }
+            // E along pd only sees the gradient of F
+            if (icomp != pd || has_F) {
+                psi_E[idim][icomp].reset(new MultiFab(amrex::convert(psi_ba,E_nodal_flag[icomp]),
+                                                      psi_dm, 1, ngpsi));
+                psi_E[idim][icomp]->setVal(0.0);
+            }
+        }
+
+        if (has_F) {
+            psi_F[idim].reset(new MultiFab(amrex::convert(psi_ba,IntVect::TheUnitVector()),
+                                           psi_dm, 1, ngpsi));
+            psi_F[idim]->setVal(0.0);
+        }
     }
-    if (sigba_cp) {
-        sigba_cp->ComputePMLFactorsB(m_cgeom->CellSize(), dt);
-        sigba_cp->ComputePMLFactorsE(m_cgeom->CellSize(), dt);
+}
+
+void
+PML::RedistributeMemoryVars (PatchType patch_type)
+{
+    const bool fine = (patch_type == PatchType::fine);
+    const DistributionMapping& dm = (fine) ? sigba_fp->DistributionMap()
+                                           : sigba_cp->DistributionMap();
+    auto& psi_box = (fine) ? psi_box_fp : psi_box_cp;
+    auto& psi_E   = (fine) ? psi_E_fp   : psi_E_cp;
+    auto& psi_B   = (fine) ? psi_B_fp   : psi_B_cp;
+    auto& psi_F   = (fine) ? psi_F_fp   : psi_F_cp;
+
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        if (psi_box[idim].empty()) continue;
+        const DistributionMapping& psi_dm = SubsetDistributionMap(psi_box[idim], dm);
+        for (int icomp = 0; icomp < 3; ++icomp) {
+            RedistributeMF(psi_E[idim][icomp], psi_dm);
+            RedistributeMF(psi_B[idim][icomp], psi_dm);
+        }
+        RedistributeMF(psi_F[idim], psi_dm);
+    }
+}
+
+Vector<MultiFab*>
+PML::GetMemoryVars (PatchType patch_type)
+{
+    const bool fine = (patch_type == PatchType::fine);
+    auto& psi_E = (fine) ? psi_E_fp : psi_E_cp;
+    auto& psi_B = (fine) ? psi_B_fp : psi_B_cp;
+    auto& psi_F = (fine) ? psi_F_fp : psi_F_cp;
+
+    Vector<MultiFab*> mfs;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        for (int icomp = 0; icomp < 3; ++icomp) {
+            if (psi_E[idim][icomp]) mfs.push_back(psi_E[idim][icomp].get());
+            if (psi_B[idim][icomp]) mfs.push_back(psi_B[idim][icomp].get());
+        }
+        if (psi_F[idim]) mfs.push_back(psi_F[idim].get());
+    }
+    return mfs;
+}
+
+/* \brief Recursive convolution of the derivative of src along idim,
+ * added to fld.  The conductivity is taken on the staggering of fld.
+ */
+void
+PML::PushMemory (MultiFab& psi, const Vector<int>& psi_box, MultiFab& fld, const MultiFab& src,
+                 const MultiSigmaBox& sigba, int idim, int ishift, Real coef, Real dt)
+{
+    const bool nodal = fld.ixType().nodeCentered(idim);
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(psi, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const int ibox = psi_box[mfi.index()];
+        const Sigma& sig = (nodal) ? sigba[ibox].sigma[idim] : sigba[ibox].sigma_star[idim];
+        WRPX_PUSH_CPML_PSI(bx.loVect(), bx.hiVect(),
+                           BL_TO_FORTRAN_3D(fld[ibox]),
+                           BL_TO_FORTRAN_3D(src[ibox]),
+                           BL_TO_FORTRAN_3D(psi[mfi]),
+                           sig.data(), sig.m_lo, sig.m_hi,
+                           idim, ishift, &coef, &dt);
+    }
+}
+
+void
+PML::PushMemoryB (PatchType patch_type, Real dt)
+{
+    const bool fine = (patch_type == PatchType::fine);
+    if (!(fine ? pml_B_fp[0] : pml_B_cp[0])) return;
+
+    auto& pml_E = (fine) ? pml_E_fp : pml_E_cp;
+    auto& pml_B = (fine) ? pml_B_fp : pml_B_cp;
+    auto& psi_B = (fine) ? psi_B_fp : psi_B_cp;
+    const auto& psi_box = (fine) ? psi_box_fp : psi_box_cp;
+    const MultiSigmaBox& sigba = (fine) ? *sigba_fp : *sigba_cp;
+    const Real* dx = (fine) ? m_geom->CellSize() : m_cgeom->CellSize();
+
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        const int pd = PhysicalDirection(idim);
+        const int c1 = (pd+1) % 3;
+        const int c2 = (pd+2) % 3;
+        const Real dtsdx = dt/dx[idim];
+        if (psi_B[idim][c1]) {
+            PushMemory(*psi_B[idim][c1], psi_box[idim], *pml_B[c1], *pml_E[c2],
+                       sigba, idim, 1,  dtsdx, dt);
+        }
+        if (psi_B[idim][c2]) {
+            PushMemory(*psi_B[idim][c2], psi_box[idim], *pml_B[c2], *pml_E[c1],
+                       sigba, idim, 1, -dtsdx, dt);
+        }
+    }
+}
+
+void
+PML::PushMemoryE (PatchType patch_type, Real dt)
+{
+    const bool fine = (patch_type == PatchType::fine);
+    if (!(fine ? pml_E_fp[0] : pml_E_cp[0])) return;
+
+    auto& pml_E = (fine) ? pml_E_fp : pml_E_cp;
+    auto& pml_B = (fine) ? pml_B_fp : pml_B_cp;
+    auto& pml_F = (fine) ? pml_F_fp : pml_F_cp;
+    auto& psi_E = (fine) ? psi_E_fp : psi_E_cp;
+    const auto& psi_box = (fine) ? psi_box_fp : psi_box_cp;
+    const MultiSigmaBox& sigba = (fine) ? *sigba_fp : *sigba_cp;
+    const Real* dx = (fine) ? m_geom->CellSize() : m_cgeom->CellSize();
+
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        const int pd = PhysicalDirection(idim);
+        const int c1 = (pd+1) % 3;
+        const int c2 = (pd+2) % 3;
+        const Real dtsdx_c2 = PhysConst::c*PhysConst::c*dt/dx[idim];
+        if (psi_E[idim][c1]) {
+            PushMemory(*psi_E[idim][c1], psi_box[idim], *pml_E[c1], *pml_B[c2],
+                       sigba, idim, 0, -dtsdx_c2, dt);
+        }
+        if (psi_E[idim][c2]) {
+            PushMemory(*psi_E[idim][c2], psi_box[idim], *pml_E[c2], *pml_B[c1],
+                       sigba, idim, 0,  dtsdx_c2, dt);
+        }
+        if (pml_F && psi_E[idim][pd]) {
+            PushMemory(*psi_E[idim][pd], psi_box[idim], *pml_E[pd], *pml_F,
+                       sigba, idim, 1,  dtsdx_c2, dt);
+        }
+    }
+}
+
+void
+PML::PushMemoryF (PatchType patch_type, Real dt)
+{
+    const bool fine = (patch_type == PatchType::fine);
+    auto& pml_F = (fine) ? pml_F_fp : pml_F_cp;
+    if (!pml_F) return;
+
+    auto& pml_E = (fine) ? pml_E_fp : pml_E_cp;
+    auto& psi_F = (fine) ? psi_F_fp : psi_F_cp;
+    const auto& psi_box = (fine) ? psi_box_fp : psi_box_cp;
+    const MultiSigmaBox& sigba = (fine) ? *sigba_fp : *sigba_cp;
+    const Real* dx = (fine) ? m_geom->CellSize() : m_cgeom->CellSize();
+
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        const int pd = PhysicalDirection(idim);
+        if (psi_F[idim]) {
+            PushMemory(*psi_F[idim], psi_box[idim], *pml_F, *pml_E[pd],
+                       sigba, idim, 0, dt/dx[idim], dt);
+        }
     }
 }
 
@@ -597,14 +890,19 @@ PML::Exchange (MultiFab& pml, MultiFab& reg, const Geometry& geom)
 
     if (ngp.max() > 0)  // Copy from pml to the ghost cells of regular data
     {
-        MultiFab totpmlmf(pml.boxArray(), pml.DistributionMap(), 1, 0);
-        MultiFab::LinComb(totpmlmf, 1.0, pml, 0, 1.0, pml, 1, 0, 1, 0);
-        if (ncp == 3) {
-            MultiFab::Add(totpmlmf,pml,2,0,1,0);
+        // The convolutional PML has a single component, no need to sum
+        MultiFab totpmlmf;
+        if (ncp > 1) {
+            totpmlmf.define(pml.boxArray(), pml.DistributionMap(), 1, 0);
+            MultiFab::Copy(totpmlmf, pml, 0, 0, 1, 0);
+            for (int icomp = 1; icomp < ncp; ++icomp) {
+                MultiFab::Add(totpmlmf, pml, icomp, 0, 1, 0);
+            }
         }
+        const MultiFab& totpml = (ncp > 1) ? totpmlmf : pml;
 
         MultiFab::Copy(tmpregmf, reg, 0, 0, 1, ngr);
-        tmpregmf.ParallelCopy(totpmlmf, 0, 0, 1, IntVect(0), ngr, period);
+        tmpregmf.ParallelCopy(totpml, 0, 0, 1, IntVect(0), ngr, period);
 
 #ifdef _OPENMP
 #pragma omp parallel
@@ -624,7 +922,9 @@ PML::Exchange (MultiFab& pml, MultiFab& reg, const Geometry& geom)
     // Copy from regular data to PML's first component
     // Zero out the second (and third) component
     MultiFab::Copy(tmpregmf,reg,0,0,1,0);
-    tmpregmf.setVal(0.0, 1, ncp-1, 0);
+    if (ncp > 1) {
+        tmpregmf.setVal(0.0, 1, ncp-1, 0);
+    }
     pml.ParallelCopy(tmpregmf, 0, 0, ncp, IntVect(0), ngp, period);
 }
 
@@ -709,6 +1009,19 @@ PML::FillBoundaryF (PatchType patch_type)
 void
 PML::CheckPoint (const std::string& dir) const
 {
+    // The fields stored depend on the type of PML, so save it for Restart
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const std::string& HeaderFileName = dir+"_Header";
+        std::ofstream HeaderFile(HeaderFileName.c_str(), std::ofstream::out   |
+                                                         std::ofstream::trunc |
+                                                         std::ofstream::binary);
+        if( ! HeaderFile.good()) {
+            amrex::FileOpenFailed(HeaderFileName);
+        }
+        HeaderFile << static_cast<int>(m_type) << "\n";
+    }
+
     if (pml_E_fp[0])
     {
         VisMF::Write(*pml_E_fp[0], dir+"_Ex_fp");
@@ -728,11 +1041,42 @@ PML::CheckPoint (const std::string& dir) const
         VisMF::Write(*pml_B_cp[1], dir+"_By_cp");
         VisMF::Write(*pml_B_cp[2], dir+"_Bz_cp");
     }
+
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        const std::string& sdim = std::to_string(idim);
+        for (int icomp = 0; icomp < 3; ++icomp)
+        {
+            const std::string& sfx = sdim + std::to_string(icomp);
+            if (psi_E_fp[idim][icomp]) VisMF::Write(*psi_E_fp[idim][icomp], dir+"_psiE"+sfx+"_fp");
+            if (psi_B_fp[idim][icomp]) VisMF::Write(*psi_B_fp[idim][icomp], dir+"_psiB"+sfx+"_fp");
+            if (psi_E_cp[idim][icomp]) VisMF::Write(*psi_E_cp[idim][icomp], dir+"_psiE"+sfx+"_cp");
+            if (psi_B_cp[idim][icomp]) VisMF::Write(*psi_B_cp[idim][icomp], dir+"_psiB"+sfx+"_cp");
+        }
+        if (psi_F_fp[idim]) VisMF::Write(*psi_F_fp[idim], dir+"_psiF"+sdim+"_fp");
+        if (psi_F_cp[idim]) VisMF::Write(*psi_F_cp[idim], dir+"_psiF"+sdim+"_cp");
+    }
 }
 
 void
 PML::Restart (const std::string& dir)
 {
+    // Checkpoints without a header predate the convolutional PML
+    PMLType chk_type = PMLType::Split;
+    const std::string& HeaderFileName = dir+"_Header";
+    if (amrex::FileExists(HeaderFileName))
+    {
+        Vector<char> fileCharPtr;
+        ParallelDescriptor::ReadAndBcastFile(HeaderFileName, fileCharPtr);
+        std::istringstream is(fileCharPtr.dataPtr());
+        int itype;
+        is >> itype;
+        chk_type = static_cast<PMLType>(itype);
+    }
+    if (chk_type != m_type) {
+        amrex::Abort("PML::Restart: the checkpoint was written with a different warpx.pml_type");
+    }
+
     if (pml_E_fp[0])
     {
         VisMF::Read(*pml_E_fp[0], dir+"_Ex_fp");
@@ -752,4 +1096,19 @@ PML::Restart (const std::string& dir)
         VisMF::Read(*pml_B_cp[1], dir+"_By_cp");
         VisMF::Read(*pml_B_cp[2], dir+"_Bz_cp");
     }
+
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+    {
+        const std::string& sdim = std::to_string(idim);
+        for (int icomp = 0; icomp < 3; ++icomp)
+        {
+            const std::string& sfx = sdim + std::to_string(icomp);
+            if (psi_E_fp[idim][icomp]) VisMF::Read(*psi_E_fp[idim][icomp], dir+"_psiE"+sfx+"_fp");
+            if (psi_B_fp[idim][icomp]) VisMF::Read(*psi_B_fp[idim][icomp], dir+"_psiB"+sfx+"_fp");
+            if (psi_E_cp[idim][icomp]) VisMF::Read(*psi_E_cp[idim][icomp], dir+"_psiE"+sfx+"_cp");
+            if (psi_B_cp[idim][icomp]) VisMF::Read(*psi_B_cp[idim][icomp], dir+"_psiB"+sfx+"_cp");
+        }
+        if (psi_F_fp[idim]) VisMF::Read(*psi_F_fp[idim], dir+"_psiF"+sdim+"_fp");
+        if (psi_F_cp[idim]) VisMF::Read(*psi_F_cp[idim], dir+"_psiF"+sdim+"_cp");
+    }
 }
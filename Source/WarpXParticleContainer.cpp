@@ -1,11 +1,16 @@
 
 #include <limits>
+#include <cstring>
+#include <map>
+#include <algorithm>
+#include <cmath>
 
 #include <ParticleContainer.H>
 #include <WarpXParticleContainer.H>
 #include <AMReX_AmrParGDB.H>
 #include <WarpX_f.H>
 #include <WarpX.H>
+#include <WarpXUtil.H>
 
 using namespace amrex;
 
@@ -95,6 +100,113 @@ WarpXParticleContainer::AllocData ()
     resizeData();
 }
 
+void
+WarpXParticleContainer::RedistributeMovedGrids (int lev, const DistributionMapping& old_dm)
+{
+    BL_PROFILE("WarpXParticleContainer::RedistributeMovedGrids()");
+
+#ifdef BL_USE_MPI
+    const DistributionMapping& new_dm = ParticleDistributionMap(lev);
+    const int myproc = ParallelDescriptor::MyProc();
+    const int nboxes = ParticleBoxArray(lev).size();
+
+    // One message per pair of processes that exchange grids, possibly empty
+    std::map<int, Vector<char> > send_data;
+    std::map<int, Vector<char> > recv_data;
+    for (int i = 0; i < nboxes; ++i) {
+        if (old_dm[i] == new_dm[i]) continue;
+        if (old_dm[i] == myproc) send_data[new_dm[i]];
+        if (new_dm[i] == myproc) recv_data[old_dm[i]];
+    }
+
+    // Pack the tiles of the grids that this process loses:
+    // grid, tile and number of particles, then the particles and their attributes
+    auto pack = [] (Vector<char>& buf, const void* src, std::size_t nbytes) {
+        const char* c = static_cast<const char*>(src);
+        buf.insert(buf.end(), c, c+nbytes);
+    };
+    auto& pmap = GetParticles(lev);
+    for (auto it = pmap.begin(); it != pmap.end(); )
+    {
+        const int grid = it->first.first;
+        if (old_dm[grid] != myproc || new_dm[grid] == myproc) {
+            ++it;
+            continue;
+        }
+        Vector<char>& buf = send_data[new_dm[grid]];
+        auto& ptile = it->second;
+        const int np = ptile.GetArrayOfStructs().size();
+        const int header[3] = {grid, it->first.second, np};
+        pack(buf, header, sizeof(header));
+        if (np > 0) {
+            pack(buf, &(ptile.GetArrayOfStructs()[0]), np*sizeof(ParticleType));
+            for (int comp = 0; comp < PIdx::nattribs; ++comp) {
+                pack(buf, &(ptile.GetStructOfArrays().GetRealData(comp)[0]), np*sizeof(Real));
+            }
+        }
+        it = pmap.erase(it);
+    }
+
+    // Exchange the sizes, and then the data
+    MPI_Comm comm = ParallelDescriptor::Communicator();
+    const int tag = ParallelDescriptor::SeqNum();
+    Vector<MPI_Request> reqs;
+    std::map<int, long> recv_sizes;
+    Vector<long> send_sizes;
+    send_sizes.reserve(send_data.size());
+    for (auto& kv : recv_data) {
+        reqs.push_back(MPI_Request());
+        MPI_Irecv(&recv_sizes[kv.first], 1, MPI_LONG, kv.first, tag, comm, &reqs.back());
+    }
+    for (auto& kv : send_data) {
+        send_sizes.push_back(kv.second.size());
+        reqs.push_back(MPI_Request());
+        MPI_Isend(&send_sizes.back(), 1, MPI_LONG, kv.first, tag, comm, &reqs.back());
+    }
+    MPI_Waitall(reqs.size(), reqs.dataPtr(), MPI_STATUSES_IGNORE);
+
+    reqs.clear();
+    const int data_tag = ParallelDescriptor::SeqNum();
+    for (auto& kv : recv_data) {
+        kv.second.resize(recv_sizes[kv.first]);
+        reqs.push_back(MPI_Request());
+        MPI_Irecv(kv.second.dataPtr(), kv.second.size(), MPI_CHAR, kv.first, data_tag,
+                  comm, &reqs.back());
+    }
+    for (auto& kv : send_data) {
+        reqs.push_back(MPI_Request());
+        MPI_Isend(kv.second.dataPtr(), kv.second.size(), MPI_CHAR, kv.first, data_tag,
+                  comm, &reqs.back());
+    }
+    MPI_Waitall(reqs.size(), reqs.dataPtr(), MPI_STATUSES_IGNORE);
+
+    // Unpack the received tiles
+    for (auto& kv : recv_data)
+    {
+        const char* c = kv.second.dataPtr();
+        const char* end = c + kv.second.size();
+        while (c < end)
+        {
+            int header[3];
+            std::memcpy(header, c, sizeof(header));
+            c += sizeof(header);
+            const int np = header[2];
+            auto& ptile = pmap[std::make_pair(header[0],header[1])];
+            const int old_np = ptile.GetArrayOfStructs().size();
+            ptile.resize(old_np + np);
+            if (np > 0) {
+                std::memcpy(&(ptile.GetArrayOfStructs()[old_np]), c, np*sizeof(ParticleType));
+                c += np*sizeof(ParticleType);
+                for (int comp = 0; comp < PIdx::nattribs; ++comp) {
+                    std::memcpy(&(ptile.GetStructOfArrays().GetRealData(comp)[old_np]), c, np*sizeof(Real));
+                    c += np*sizeof(Real);
+                }
+            }
+        }
+    }
+#endif
+}
+
 void
 WarpXParticleContainer::AddOneParticle (int lev, int grid, int tile,
                                         Real x, Real y, Real z,
@@ -125,6 +237,177 @@ WarpXParticleContainer::AddOneParticle (ParticleTileType& particle_tile,
     particle_tile.push_back_real(attribs);
 }
 
+void
+WarpXParticleContainer::RemoveInvalidParticles (ParticleTileType& particle_tile, long start)
+{
+    auto& aos = particle_tile.GetArrayOfStructs();
+    const long np = aos.size();
+    std::array<Real*,PIdx::nattribs> soa;
+    for (int kk = 0; kk < PIdx::nattribs; ++kk) {
+        soa[kk] = particle_tile.GetStructOfArrays().GetRealData(kk).dataPtr();
+    }
+
+    long new_size = start;
+    for (long i = start; i < np; ++i) {
+        if (aos[i].id() < 0) continue;
+        if (i != new_size) {
+            aos[new_size] = aos[i];
+            for (int kk = 0; kk < PIdx::nattribs; ++kk) {
+                soa[kk][new_size] = soa[kk][i];
+            }
+        }
+        ++new_size;
+    }
+    if (new_size < np) {
+        particle_tile.resize(new_size);
+    }
+}
+
+void
+WarpXParticleContainer::MergeParticles (int max_ppc)
+{
+    BL_PROFILE("WarpXParticleContainer::MergeParticles()");
+
+    AMREX_ALWAYS_ASSERT(max_ppc >= 2);
+    const int ngroups = max_ppc/2;
+    const Real c = PhysConst::c;
+
+    for (int lev = 0; lev <= finestLevel(); ++lev)
+    {
+        const Geometry& geom = Geom(lev);
+        const Real* plo = geom.ProbLo();
+        const Real* dxi = geom.InvCellSize();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Vector<long> order;
+            for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
+            {
+                auto& particle_tile = GetParticles(lev)[std::make_pair(pti.index(),pti.LocalTileIndex())];
+                auto& aos = particle_tile.GetArrayOfStructs();
+                const long np = aos.size();
+                if (np <= max_ppc) continue;
+
+                std::array<Real*,PIdx::nattribs> soa;
+                for (int kk = 0; kk < PIdx::nattribs; ++kk) {
+                    soa[kk] = particle_tile.GetStructOfArrays().GetRealData(kk).dataPtr();
+                }
+                const Real* w  = soa[PIdx::w ];
+                const Real* ux = soa[PIdx::ux];
+                const Real* uy = soa[PIdx::uy];
+                const Real* uz = soa[PIdx::uz];
+
+                auto cell_index = [&] (long i) {
+                    const ParticleType& p = aos[i];
+                    return IntVect(AMREX_D_DECL(static_cast<int>(std::floor((p.pos(0)-plo[0])*dxi[0])),
+                                                static_cast<int>(std::floor((p.pos(1)-plo[1])*dxi[1])),
+                                                static_cast<int>(std::floor((p.pos(2)-plo[2])*dxi[2]))));
+                };
+                // Particles with similar momenta are merged together:
+                // order them by octant of u, then by |u|
+                auto momentum_less = [&] (long i, long j) {
+                    const int oi = (ux[i]<0) + 2*(uy[i]<0) + 4*(uz[i]<0);
+                    const int oj = (ux[j]<0) + 2*(uy[j]<0) + 4*(uz[j]<0);
+                    if (oi != oj) return oi < oj;
+                    return ux[i]*ux[i]+uy[i]*uy[i]+uz[i]*uz[i] < ux[j]*ux[j]+uy[j]*uy[j]+uz[j]*uz[j];
+                };
+
+                bool merged = false;
+                long begin = 0;
+                while (begin < np)
+                {
+                    // Particles are sorted by cell: [begin,end) is one cell
+                    const IntVect iv = cell_index(begin);
+                    long end = begin+1;
+                    while (end < np and cell_index(end) == iv) ++end;
+                    const long n = end - begin;
+                    if (n > max_ppc)
+                    {
+                        merged = true;
+                        order.resize(n);
+                        for (long i = 0; i < n; ++i) order[i] = begin + i;
+                        std::sort(order.begin(), order.end(), momentum_less);
+
+                        for (int g = 0; g < ngroups; ++g)
+                        {
+                            const long gbegin = (n*g)/ngroups;
+                            const long gend = (n*(g+1))/ngroups;
+
+                            // Totals of the group: weight, momentum, energy (gamma)
+                            // and weighted averages of the positions and other attributes
+                            Real wt = 0., px = 0., py = 0., pz = 0., et = 0.;
+                            std::array<Real,AMREX_SPACEDIM> pos {};
+                            std::array<Real,PIdx::nattribs> attribs {};
+                            for (long k = gbegin; k < gend; ++k) {
+                                const long i = order[k];
+                                wt += w[i];
+                                px += w[i]*ux[i];
+                                py += w[i]*uy[i];
+                                pz += w[i]*uz[i];
+                                et += w[i]*std::sqrt(1. + (ux[i]*ux[i]+uy[i]*uy[i]+uz[i]*uz[i])/(c*c));
+                                for (int d = 0; d < AMREX_SPACEDIM; ++d) pos[d] += w[i]*aos[i].pos(d);
+                                for (int kk = 0; kk < PIdx::nattribs; ++kk) attribs[kk] += w[i]*soa[kk][i];
+                            }
+                            if (wt <= 0.) continue;
+                            for (int d = 0; d < AMREX_SPACEDIM; ++d) pos[d] /= wt;
+                            for (int kk = 0; kk < PIdx::nattribs; ++kk) attribs[kk] /= wt;
+
+                            // Two particles of weight wt/2 and of same |u|, which conserve
+                            // the energy, symmetric with respect to the total momentum
+                            const Real gamma = et/wt;
+                            const Real u_norm = c*std::sqrt(std::max(gamma*gamma - 1., 0.));
+                            const Real p_norm = std::sqrt(px*px + py*py + pz*pz);
+                            std::array<Real,3> e1 {1., 0., 0.};
+                            if (p_norm > 0.) e1 = {px/p_norm, py/p_norm, pz/p_norm};
+                            const Real cos_theta = (u_norm > 0.) ? std::min(p_norm/(wt*u_norm), 1.) : 1.;
+                            const Real sin_theta = std::sqrt(1. - cos_theta*cos_theta);
+
+                            // e2: direction of the first particle of the group, orthogonal to e1
+                            const long i0 = order[gbegin];
+                            std::array<Real,3> e2 {ux[i0], uy[i0], uz[i0]};
+                            Real proj = e2[0]*e1[0] + e2[1]*e1[1] + e2[2]*e1[2];
+                            for (int d = 0; d < 3; ++d) e2[d] -= proj*e1[d];
+                            Real e2_norm = std::sqrt(e2[0]*e2[0] + e2[1]*e2[1] + e2[2]*e2[2]);
+                            if (e2_norm <= 1.e-12*u_norm or e2_norm == 0.) {
+                                // Any direction orthogonal to e1
+                                const int d = (std::abs(e1[0]) < 0.5) ? 0 : 1;
+                                e2 = {0., 0., 0.};
+                                e2[d] = 1.;
+                                proj = e1[d];
+                                for (int dd = 0; dd < 3; ++dd) e2[dd] -= proj*e1[dd];
+                                e2_norm = std::sqrt(e2[0]*e2[0] + e2[1]*e2[1] + e2[2]*e2[2]);
+                            }
+                            for (int d = 0; d < 3; ++d) e2[d] /= e2_norm;
+
+                            for (long k = gbegin; k < gend; ++k) {
+                                const long i = order[k];
+                                if (k >= gbegin+2) {
+                                    aos[i].id() = -1;
+                                    continue;
+                                }
+                                const Real sign = (k == gbegin) ? 1. : -1.;
+                                for (int d = 0; d < AMREX_SPACEDIM; ++d) aos[i].pos(d) = pos[d];
+                                for (int kk = 0; kk < PIdx::nattribs; ++kk) soa[kk][i] = attribs[kk];
+                                soa[PIdx::w ][i] = 0.5*wt;
+                                soa[PIdx::ux][i] = u_norm*(cos_theta*e1[0] + sign*sin_theta*e2[0]);
+                                soa[PIdx::uy][i] = u_norm*(cos_theta*e1[1] + sign*sin_theta*e2[1]);
+                                soa[PIdx::uz][i] = u_norm*(cos_theta*e1[2] + sign*sin_theta*e2[2]);
+                            }
+                        }
+                    }
+                    begin = end;
+                }
+
+                if (merged) {
+                    RemoveInvalidParticles(particle_tile);
+                }
+            }
+        }
+    }
+}
+
 void
 WarpXParticleContainer::AddNParticles (int lev,
                                        int n, const Real* x, const Real* y, const Real* z,
@@ -134,22 +417,12 @@ WarpXParticleContainer::AddNParticles (int lev,
     BL_ASSERT(nattr == 1);
     const Real* weight = attr;
 
-    int ibegin, iend;
+    long ibegin, iend;
     if (uniqueparticles) {
 	ibegin = 0;
 	iend = n;
     } else {
-	int myproc = ParallelDescriptor::MyProc();
-	int nprocs = ParallelDescriptor::NProcs();
-	int navg = n/nprocs;
-	int nleft = n - navg * nprocs;
-	if (myproc < nleft) {
-	    ibegin = myproc*(navg+1);
-	    iend = ibegin + navg+1;
-	} else {
-	    ibegin = myproc*navg + nleft;
-	    iend = ibegin + navg;
-	}
+	SplitAmongRanks(n, ibegin, iend);
     }
 
     //  Add to grid 0 and tile 0
@@ -157,7 +430,7 @@ WarpXParticleContainer::AddNParticles (int lev,
     std::pair<int,int> key {0,0};
     auto& particle_tile = GetParticles(lev)[key];
 
-    for (int i = ibegin; i < iend; ++i)
+    for (long i = ibegin; i < iend; ++i)
     {
         ParticleType p;
         p.id()  = ParticleType::NextID();
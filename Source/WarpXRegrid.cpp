@@ -1,9 +1,38 @@
 
 #include <WarpX.H>
+#include <WarpXUtil.H>
 #include <AMReX_BLProfiler.H>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
 
 using namespace amrex;
 
+namespace
+{
+    // Largest cost of a process, if the boxes are distributed according to `dm`
+    Real MaxProcCost (const Vector<Real>& box_costs, const DistributionMapping& dm)
+    {
+        Vector<Real> proc_costs(ParallelDescriptor::NProcs(), 0.0);
+        for (int i = 0, N = box_costs.size(); i < N; ++i) {
+            proc_costs[dm[i]] += box_costs[i];
+        }
+        return *std::max_element(proc_costs.begin(), proc_costs.end());
+    }
+}
+
+/* \brief Redistribute the boxes of each level across MPI ranks according to
+ * the measured costs.
+ *
+ * If load_balance_with_box_splitting is on, the boxes that are too expensive
+ * to be balanced are first split (and cheap neighboring boxes merged), see
+ * SplitBoxesByCost; the level is then rebuilt on the new grids, as when
+ * regridding.
+ *
+ * The new DistributionMapping is only applied if the time that it is expected
+ * to save before the next load balancing exceeds the estimated time needed to
+ * move the data of the boxes that change owner.
+ */
 void
 WarpX::LoadBalance ()
 {
@@ -12,20 +41,431 @@ WarpX::LoadBalance ()
 
     AMREX_ALWAYS_ASSERT(costs[0] != nullptr);
 
+    // The costs are a running average (see Evolve): number of steps
+    // that they effectively represent
+    const Real r = 1. - 2./load_balance_int;
+    Real nsteps_eff = (r > 0.) ? (1. - std::pow(r, load_balance_int))/(1. - r) : 1.;
+
+    if (load_balance_with_cost_model) {
+        // The costs now hold the modeled cost of one step
+        UpdateCostsModel(nsteps_eff);
+        nsteps_eff = 1.;
+    }
+
+    bool grids_changed = false;
+
     for (int lev = 0; lev <= finestLevel(); ++lev)
     {
-        const Real nboxes = costs[lev]->size();
         const Real nprocs = ParallelDescriptor::NProcs();
+        const DistributionMapping olddm = DistributionMap(lev);
+
+        // Cost of each box, per time step
+        Vector<Real> box_costs(costs[lev]->size(), 0.0);
+        for (MFIter mfi(*costs[lev]); mfi.isValid(); ++mfi) {
+            box_costs[mfi.index()] = (*costs[lev])[mfi].sum(mfi.validbox(), 0) / nsteps_eff;
+        }
+        ParallelDescriptor::ReduceRealSum(box_costs.data(), box_costs.size());
+        const Real total_cost = std::accumulate(box_costs.begin(), box_costs.end(), 0.0);
+
+        BoxArray newba = boxArray(lev);
+        Vector<Real> new_box_costs = box_costs;
+        if (load_balance_with_box_splitting) {
+            SplitBoxesByCost(lev, load_balance_box_cost_fraction*total_cost/nprocs, nsteps_eff,
+                             newba, new_box_costs);
+        }
+        const bool same_grids = (newba == boxArray(lev));
+
+        DistributionMapping newdm;
+        const Real nboxes = newba.size();
         const int nmax = static_cast<int>(std::ceil(nboxes/nprocs*load_balance_knapsack_factor));
-        const DistributionMapping newdm = (load_balance_with_sfc)
-	  ? DistributionMapping::makeSFC(*costs[lev], false)
-            : DistributionMapping::makeKnapSack(*costs[lev], nmax);
-        RemakeLevel(lev, t_new[lev], boxArray(lev), newdm);
+        if (same_grids)
+        {
+            newdm = (load_balance_with_sfc)
+                ? DistributionMapping::makeSFC(*costs[lev], false)
+                : DistributionMapping::makeKnapSack(*costs[lev], nmax);
+            if (newdm == olddm) continue;
+        }
+        else
+        {
+            // Uniform cost within each of the new boxes
+            MultiFab weight(newba, DistributionMapping(newba), 1, 0);
+            for (MFIter mfi(weight); mfi.isValid(); ++mfi) {
+                weight[mfi].setVal(new_box_costs[mfi.index()]/mfi.validbox().d_numPts());
+            }
+            newdm = (load_balance_with_sfc)
+                ? DistributionMapping::makeSFC(weight, false)
+                : DistributionMapping::makeKnapSack(weight, nmax);
+        }
+
+        const Real old_max = MaxProcCost(box_costs, olddm);
+        const Real new_max = MaxProcCost(new_box_costs, newdm);
+
+        // Time saved until the next load balancing, and time spent moving the data
+        const Real savings = (old_max - new_max) * load_balance_int;
+        const Vector<long> bytes = LoadBalanceMigrationBytes(lev, newba, newdm);
+        const long max_bytes = *std::max_element(bytes.begin(), bytes.end());
+        const Real migration_time = max_bytes / load_balance_bandwidth;
+        const bool do_remap = (savings > migration_time);
+
+        if (verbose) {
+            amrex::Print() << "LoadBalance: level " << lev
+                           << ": efficiency " << ((old_max > 0.) ? total_cost/(nprocs*old_max) : 1.)
+                           << " -> " << ((new_max > 0.) ? total_cost/(nprocs*new_max) : 1.);
+            if (!same_grids) {
+                amrex::Print() << " with " << newba.size() << " boxes (instead of "
+                               << boxArray(lev).size() << ")";
+            }
+            amrex::Print() << ", expected savings " << savings << " s"
+                           << ", moving up to " << max_bytes << " bytes per process (~"
+                           << migration_time << " s): "
+                           << (do_remap ? "remapping" : "keeping the current mapping") << "\n";
+        }
+
+        if (!do_remap) continue;
+
+        Real wt = amrex::second();
+        if (same_grids)
+        {
+            RemakeLevel(lev, t_new[lev], newba, newdm);
+            // The particles are still in the right grids: only the tiles of the
+            // grids that changed owner need to be sent.
+            mypc->RedistributeMovedGrids(lev, olddm);
+        }
+        else
+        {
+            RemakeLevel(lev, t_new[lev], newba, newdm);
+            SetBoxArray(lev, newba);
+            SetDistributionMap(lev, newdm);
+            grids_changed = true;
+        }
+        wt = amrex::second() - wt;
+        ParallelDescriptor::ReduceRealMax(wt);
+
+        // Use the measured bandwidth for the next estimates
+        if (same_grids && max_bytes > 0 && wt > 0.) {
+            load_balance_bandwidth = max_bytes / wt;
+        }
+    }
+
+    if (grids_changed)
+    {
+        // As in Regrid
+        BuildBufferMasks();
+        mypc->Redistribute();
+    }
+}
+
+/* \brief Split the boxes of level `lev` whose cost exceeds `max_cost` (in halves,
+ * along their longest splittable direction, until they are cheap enough or
+ * cannot be split anymore), and merge pairs of neighboring boxes whose total
+ * cost is below max_cost/2 (and whose union is a box that fits in max_grid_size).
+ *
+ * The cost of the new boxes is measured from the costs MultiFab (divided by
+ * `nsteps_eff`). On output, `ba` and `box_costs` hold the new boxes and their cost.
+ */
+void
+WarpX::SplitBoxesByCost (int lev, Real max_cost, Real nsteps_eff,
+                         BoxArray& ba, Vector<Real>& box_costs) const
+{
+    const IntVect& bf = blockingFactor(lev);
+    const IntVect& mgs = maxGridSize(lev);
+    // The PML requires boxes larger than its number of cells
+    const int min_side = (do_pml) ? pml_ncell+1 : 1;
+    const int myproc = ParallelDescriptor::MyProc();
+    const DistributionMapping& dm = costs[lev]->DistributionMap();
+
+    Vector<Box> boxes(ba.size());
+    Vector<int> parent(ba.size());
+    for (int i = 0, N = ba.size(); i < N; ++i) {
+        boxes[i] = ba[i];
+        parent[i] = i;
+    }
+
+    // Split, one level of halving at a time
+    const int max_split_rounds = 10;
+    for (int iround = 0; iround < max_split_rounds; ++iround)
+    {
+        Vector<Box> new_boxes;
+        Vector<int> new_parent;
+        Vector<Real> new_costs;
+        Vector<int> is_new;
+        for (int k = 0, N = boxes.size(); k < N; ++k)
+        {
+            Box lo = boxes[k];
+            bool split = false;
+            if (box_costs[k] > max_cost)
+            {
+                // Longest direction in which both halves are multiples of the blocking factor
+                Vector<int> dirs(AMREX_SPACEDIM);
+                std::iota(dirs.begin(), dirs.end(), 0);
+                std::sort(dirs.begin(), dirs.end(),
+                          [&lo] (int a, int b) { return lo.length(a) > lo.length(b); });
+                for (int idim : dirs)
+                {
+                    const int L = lo.length(idim);
+                    const int cut = (L/2/bf[idim])*bf[idim];
+                    const int min_len = std::max(bf[idim], min_side);
+                    if (cut >= min_len && L-cut >= min_len)
+                    {
+                        const Box hi = lo.chop(idim, lo.smallEnd(idim)+cut);
+                        new_boxes.push_back(lo);
+                        new_boxes.push_back(hi);
+                        new_parent.push_back(parent[k]);
+                        new_parent.push_back(parent[k]);
+                        new_costs.push_back(0.);
+                        new_costs.push_back(0.);
+                        is_new.push_back(1);
+                        is_new.push_back(1);
+                        split = true;
+                        break;
+                    }
+                }
+            }
+            if (!split) {
+                new_boxes.push_back(boxes[k]);
+                new_parent.push_back(parent[k]);
+                new_costs.push_back(0.);
+                is_new.push_back(0);
+            }
+        }
+        if (new_boxes.size() == boxes.size()) break;
+
+        // Cost of the new halves, summed on the owner of the original box
+        for (int k = 0, N = new_boxes.size(); k < N; ++k) {
+            if (is_new[k] && dm[new_parent[k]] == myproc) {
+                new_costs[k] = (*costs[lev])[new_parent[k]].sum(new_boxes[k], 0) / nsteps_eff;
+            }
+        }
+        ParallelDescriptor::ReduceRealSum(new_costs.data(), new_costs.size());
+        for (int k = 0, j = 0, N = new_boxes.size(); k < N; ++k) {
+            if (!is_new[k]) {
+                while (boxes[j] != new_boxes[k]) ++j;
+                new_costs[k] = box_costs[j];
+            }
+        }
+
+        std::swap(boxes, new_boxes);
+        std::swap(parent, new_parent);
+        std::swap(box_costs, new_costs);
+    }
+
+    // Merge pairs of cheap neighbors, the cheapest first
+    BoxList split_bl;
+    for (const Box& b : boxes) split_bl.push_back(b);
+    const BoxArray split_ba(std::move(split_bl));
+    Vector<int> order(boxes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&box_costs] (int a, int b) { return box_costs[a] < box_costs[b]; });
+    Vector<int> done(boxes.size(), 0);
+    BoxList bl;
+    Vector<Real> merged_costs;
+    for (int k : order)
+    {
+        if (done[k]) continue;
+        done[k] = 1;
+        Box bx = boxes[k];
+        Real c = box_costs[k];
+        if (c <= 0.5*max_cost)
+        {
+            for (const auto& isect : split_ba.intersections(amrex::grow(boxes[k],1)))
+            {
+                const int j = isect.first;
+                if (done[j] || c + box_costs[j] > 0.5*max_cost) continue;
+                Box u = boxes[k];
+                u.minBox(boxes[j]);
+                if (u.numPts() == boxes[k].numPts() + boxes[j].numPts() &&
+                    u.length().allLE(mgs))
+                {
+                    done[j] = 1;
+                    bx = u;
+                    c += box_costs[j];
+                    break;
+                }
+            }
+        }
+        bl.push_back(bx);
+        merged_costs.push_back(c);
+    }
+
+    ba = BoxArray(std::move(bl));
+    box_costs = std::move(merged_costs);
+}
+
+/* \brief Model the cost of each box as
+ *   costs_model_coefficients[0] * (number of cells)
+ * + costs_model_coefficients[1] * (number of particles) * (nox+1)^AMREX_SPACEDIM
+ *
+ * When the costs contain timings, the coefficients are first fitted to them
+ * (least squares over all the boxes of all levels), so that the model follows
+ * the actual performance of the machine while being free of the timer noise.
+ */
+void
+WarpX::UpdateCostsModel (Real nsteps_eff)
+{
+    const Real shape_points = std::pow(nox+1, AMREX_SPACEDIM);
+
+    Vector<Vector<Real> > ncells(finestLevel()+1), nparts(finestLevel()+1);
+    Real sxx = 0., sxy = 0., syy = 0., sxc = 0., syc = 0., total_cost = 0.;
+    for (int lev = 0; lev <= finestLevel(); ++lev)
+    {
+        const BoxArray& ba = boxArray(lev);
+        const Vector<long> np = mypc->NumberOfParticlesInGrid(lev);
+
+        // Measured cost of each box, per step
+        Vector<Real> box_costs(ba.size(), 0.0);
+        for (MFIter mfi(*costs[lev]); mfi.isValid(); ++mfi) {
+            box_costs[mfi.index()] = (*costs[lev])[mfi].sum(mfi.validbox(), 0) / nsteps_eff;
+        }
+        ParallelDescriptor::ReduceRealSum(box_costs.data(), box_costs.size());
+
+        ncells[lev].resize(ba.size());
+        nparts[lev].resize(ba.size());
+        for (int i = 0, N = ba.size(); i < N; ++i)
+        {
+            const Real x = ba[i].numPts();
+            const Real y = np[i]*shape_points;
+            const Real c = box_costs[i];
+            ncells[lev][i] = x;
+            nparts[lev][i] = y;
+            sxx += x*x;
+            sxy += x*y;
+            syy += y*y;
+            sxc += x*c;
+            syc += y*c;
+            total_cost += c;
+        }
+    }
+
+    if (total_cost > 0.)
+    {
+        // Non-negative least squares, for the two coefficients
+        Real a = -1., b = -1.;
+        const Real det = sxx*syy - sxy*sxy;
+        if (det > 1.e-12*sxx*syy) {
+            a = (sxc*syy - syc*sxy)/det;
+            b = (syc*sxx - sxc*sxy)/det;
+        }
+        if (a < 0. || b < 0.) {
+            // Only one of the two terms
+            const Real a_only = (sxx > 0.) ? std::max(sxc/sxx, 0.) : 0.;
+            const Real b_only = (syy > 0.) ? std::max(syc/syy, 0.) : 0.;
+            const Real res_a = a_only*a_only*sxx - 2.*a_only*sxc;
+            const Real res_b = b_only*b_only*syy - 2.*b_only*syc;
+            a = (res_a <= res_b) ? a_only : 0.;
+            b = (res_a <= res_b) ? 0. : b_only;
+        }
+        if (a > 0. || b > 0.) {
+            costs_model_coefficients = {{a, b}};
+        }
+        if (verbose) {
+            amrex::Print() << "Cost model: " << costs_model_coefficients[0] << " s per cell, "
+                           << costs_model_coefficients[1] << " s per particle and shape point\n";
+        }
+    }
+
+    // Cost of each cell, from its number of particles, so that the costs
+    // can also be used within a box (see SplitBoxesByCost)
+    for (int lev = 0; lev <= finestLevel(); ++lev)
+    {
+        costs[lev]->setVal(0.0);
+        mypc->Increment(*costs[lev], lev);
+        costs[lev]->mult(costs_model_coefficients[1]*shape_points);
+        costs[lev]->plus(costs_model_coefficients[0], 0, 1);
+    }
+}
+
+Vector<long>
+WarpX::LoadBalanceMigrationBytes (int lev, const BoxArray& newba,
+                                  const DistributionMapping& newdm) const
+{
+    const BoxArray& oldba = boxArray(lev);
+    const DistributionMapping& olddm = DistributionMap(lev);
+
+    // Fields that are copied in RemakeLevel
+    Vector<const MultiFab*> mfs;
+    for (int idim = 0; idim < 3; ++idim) {
+        mfs.push_back(Efield_fp[lev][idim].get());
+        mfs.push_back(Bfield_fp[lev][idim].get());
+        mfs.push_back(Efield_cp[lev][idim].get());
+        mfs.push_back(Bfield_cp[lev][idim].get());
     }
+    mfs.push_back(F_fp[lev].get());
+    mfs.push_back(F_cp[lev].get());
 
+    const Vector<long> np = mypc->NumberOfParticlesInGrid(lev);
+    const long particle_bytes = sizeof(WarpXParticleContainer::ParticleType)
+        + PIdx::nattribs*sizeof(Real);
+
+    Vector<long> bytes(ParallelDescriptor::NProcs(), 0);
+    for (int j = 0, N = oldba.size(); j < N; ++j)
+    {
+        long box_bytes = np[j]*particle_bytes;
+        for (const MultiFab* mf : mfs) {
+            if (mf) {
+                const Box& fabbox = amrex::grow(mf->boxArray()[j], mf->nGrowVect());
+                box_bytes += fabbox.numPts()*mf->nComp()*sizeof(Real);
+            }
+        }
+        // Fraction of the old box that goes to each new box with another owner
+        for (const auto& isect : newba.intersections(oldba[j]))
+        {
+            const int i = isect.first;
+            if (olddm[j] == newdm[i]) continue;
+            const long b = static_cast<long>(box_bytes * static_cast<Real>(isect.second.numPts())
+                                                       / oldba[j].numPts());
+            bytes[olddm[j]] += b;
+            bytes[newdm[i]] += b;
+        }
+    }
+    return bytes;
+}
+
+void
+WarpX::Regrid ()
+{
+    BL_PROFILE_REGION("Regrid");
+    BL_PROFILE("WarpX::Regrid()");
+
+    const int old_finest_level = finest_level;
+
+    regrid(0, t_new[0]);
+
+    BuildBufferMasks();
+
+    mypc->AllocData();
     mypc->Redistribute();
+
+    if (verbose && ParallelDescriptor::IOProcessor()) {
+        std::cout << "Regrid: " << old_finest_level+1 << " -> " << finest_level+1 << " levels\n";
+        printGridSummary(std::cout, 1, finest_level);
+    }
 }
 
+void
+WarpX::MakeNewLevelFromCoarse (int lev, Real time, const BoxArray& ba,
+                               const DistributionMapping& dm)
+{
+    // The fine and coarse patches only hold the fields of the particles
+    // of the patch: a new level starts from zero, and its auxiliary fields
+    // are interpolated from level lev-1 in UpdateAuxilaryData.
+    AllocLevelData(lev, ba, dm);
+    InitLevelData(lev, time);
+
+#ifdef WARPX_USE_PSATD
+    AllocLevelDataFFT(lev);
+    InitLevelDataFFT(lev, time);
+#endif
+
+    InitPML(lev, ba, dm);
+}
+
+/* \brief Remake level `lev` on the grids `ba` distributed according to `dm`.
+ *
+ * With PSATD, the FFT grids are independent of the grids of the level and of
+ * their DistributionMapping, so that they are not affected by load balancing:
+ * only the copies between the two (see PushPSATD) change.
+ */
 void
 WarpX::RemakeLevel (int lev, Real time, const BoxArray& ba, const DistributionMapping& dm)
 {
@@ -38,61 +478,25 @@ WarpX::RemakeLevel (int lev, Real time, const BoxArray& ba, const DistributionMa
         AMREX_ALWAYS_ASSERT(gather_masks[lev] == nullptr);
 #endif // WARPX_DO_ELECTROSTATIC
         
-        // Fine patch
+        // Only the data of the boxes whose owner changes are moved; the fabs
+        // of the other boxes are kept in place (see RemapFabArray).
+        // The current, charge, and auxiliary data do not need to be copied,
+        // since they are recomputed before being used.
 
-        const auto& period = Geom(lev).periodicity();
+        // Fine patch
         for (int idim=0; idim < 3; ++idim)
         {
-            {
-                const IntVect& ng = Bfield_fp[lev][idim]->nGrowVect();
-                auto pmf = std::unique_ptr<MultiFab>(new MultiFab(Bfield_fp[lev][idim]->boxArray(),
-                                                                  dm, 1, ng));
-                pmf->Redistribute(*Bfield_fp[lev][idim], 0, 0, 1, ng);
-                Bfield_fp[lev][idim] = std::move(pmf);
-            }
-            {
-                const IntVect& ng = Efield_fp[lev][idim]->nGrowVect();
-                auto pmf = std::unique_ptr<MultiFab>(new MultiFab(Efield_fp[lev][idim]->boxArray(),
-                                                                  dm, 1, ng));
-                pmf->Redistribute(*Efield_fp[lev][idim], 0, 0, 1, ng);
-                Efield_fp[lev][idim] = std::move(pmf);
-            }
-            {
-                const IntVect& ng = current_fp[lev][idim]->nGrowVect();
-                auto pmf = std::unique_ptr<MultiFab>(new MultiFab(current_fp[lev][idim]->boxArray(),
-                                                                  dm, 1, ng));
-                current_fp[lev][idim] = std::move(pmf);
-                current_fp_owner_masks[lev][idim] = std::move(current_fp[lev][idim]->OwnerMask(period));
-            }
-            if (current_store[lev][idim])
-            {
-                const IntVect& ng = current_store[lev][idim]->nGrowVect();
-                auto pmf = std::unique_ptr<MultiFab>(new MultiFab(current_store[lev][idim]->boxArray(),
-                                                                  dm, 1, ng));
-                // no need to redistribute
-                current_store[lev][idim] = std::move(pmf);
-            }
-        }
-
-        if (F_fp[lev] != nullptr) {
-            const IntVect& ng = F_fp[lev]->nGrowVect();
-            auto pmf = std::unique_ptr<MultiFab>(new MultiFab(F_fp[lev]->boxArray(),
-                                                              dm, 1, ng));
-            pmf->Redistribute(*F_fp[lev], 0, 0, 1, ng);
-            F_fp[lev] = std::move(pmf);
-        }
-
-        if (rho_fp[lev] != nullptr) {
-            const int nc = rho_fp[lev]->nComp();
-            const IntVect& ng = rho_fp[lev]->nGrowVect();
-            auto pmf = std::unique_ptr<MultiFab>(new MultiFab(rho_fp[lev]->boxArray(),
-                                                              dm, nc, ng));
-            rho_fp[lev] = std::move(pmf);
-            rho_fp_owner_masks[lev] = std::move(rho_fp[lev]->OwnerMask(period));
+            RemapFabArray<FArrayBox>(Bfield_fp[lev][idim], dm, true);
+            RemapFabArray<FArrayBox>(Efield_fp[lev][idim], dm, true);
+            RemapFabArray<FArrayBox>(current_fp[lev][idim], dm, false);
+            RemapFabArray<IArrayBox>(current_fp_owner_masks[lev][idim], dm, true);
+            RemapFabArray<FArrayBox>(current_store[lev][idim], dm, false);
         }
+        RemapFabArray<FArrayBox>(F_fp[lev], dm, true);
+        RemapFabArray<FArrayBox>(rho_fp[lev], dm, false);
+        RemapFabArray<IArrayBox>(rho_fp_owner_masks[lev], dm, true);
 
         // Aux patch
-
         if (lev == 0)
         {
             for (int idim = 0; idim < 3; ++idim) {
@@ -102,133 +506,112 @@ WarpX::RemakeLevel (int lev, Real time, const BoxArray& ba, const DistributionMa
         } else {
             for (int idim=0; idim < 3; ++idim)
             {
-                {
-                    const IntVect& ng = Bfield_aux[lev][idim]->nGrowVect();
-                    auto pmf = std::unique_ptr<MultiFab>(new MultiFab(Bfield_aux[lev][idim]->boxArray(),
-                                                                      dm, 1, ng));
-                    // pmf->Redistribute(*Bfield_aux[lev][idim], 0, 0, 1, ng);
-                    Bfield_aux[lev][idim] = std::move(pmf);
-                }
-                {
-                    const IntVect& ng = Efield_aux[lev][idim]->nGrowVect();
-                    auto pmf = std::unique_ptr<MultiFab>(new MultiFab(Efield_aux[lev][idim]->boxArray(),
-                                                                      dm, 1, ng));
-                    // pmf->Redistribute(*Efield_aux[lev][idim], 0, 0, 1, ng);
-                    Efield_aux[lev][idim] = std::move(pmf);
-                }
+                RemapFabArray<FArrayBox>(Bfield_aux[lev][idim], dm, false);
+                RemapFabArray<FArrayBox>(Efield_aux[lev][idim], dm, false);
             }
         }
 
         // Coarse patch
         if (lev > 0) {
-            const auto& cperiod = Geom(lev-1).periodicity();
             for (int idim=0; idim < 3; ++idim)
             {
-                {
-                    const IntVect& ng = Bfield_cp[lev][idim]->nGrowVect();
-                    auto pmf = std::unique_ptr<MultiFab>(new MultiFab(Bfield_cp[lev][idim]->boxArray(),
-                                                                      dm, 1, ng));
-                    pmf->Redistribute(*Bfield_cp[lev][idim], 0, 0, 1, ng);
-                    Bfield_cp[lev][idim] = std::move(pmf);
-                }
-                {
-                    const IntVect& ng = Efield_cp[lev][idim]->nGrowVect();
-                    auto pmf = std::unique_ptr<MultiFab>(new MultiFab(Efield_cp[lev][idim]->boxArray(),
-                                                                      dm, 1, ng));
-                    pmf->Redistribute(*Efield_cp[lev][idim], 0, 0, 1, ng);
-                    Efield_cp[lev][idim] = std::move(pmf);
-                }
-                {
-                    const IntVect& ng = current_cp[lev][idim]->nGrowVect();
-                    auto pmf = std::unique_ptr<MultiFab>( new MultiFab(current_cp[lev][idim]->boxArray(),
-                                                                       dm, 1, ng));
-                    current_cp[lev][idim] = std::move(pmf);
-                    current_cp_owner_masks[lev][idim] = std::move(
-                        current_cp[lev][idim]->OwnerMask(cperiod));
-                }
-            }
-
-            if (F_cp[lev] != nullptr) {
-                const IntVect& ng = F_cp[lev]->nGrowVect();
-                auto pmf = std::unique_ptr<MultiFab>(new MultiFab(F_cp[lev]->boxArray(),
-                                                                  dm, 1, ng));
-                pmf->Redistribute(*F_cp[lev], 0, 0, 1, ng);
-                F_cp[lev] = std::move(pmf);
-            }
-
-            if (rho_cp[lev] != nullptr) {
-                const int nc = rho_cp[lev]->nComp();
-                const IntVect& ng = rho_cp[lev]->nGrowVect();
-                auto pmf = std::unique_ptr<MultiFab>(new MultiFab(rho_cp[lev]->boxArray(),
-                                                                  dm, nc, ng));
-                rho_cp[lev] = std::move(pmf);
-                rho_cp_owner_masks[lev] = std::move(rho_cp[lev]->OwnerMask(cperiod));
+                RemapFabArray<FArrayBox>(Bfield_cp[lev][idim], dm, true);
+                RemapFabArray<FArrayBox>(Efield_cp[lev][idim], dm, true);
+                RemapFabArray<FArrayBox>(current_cp[lev][idim], dm, false);
+                RemapFabArray<IArrayBox>(current_cp_owner_masks[lev][idim], dm, true);
             }
+            RemapFabArray<FArrayBox>(F_cp[lev], dm, true);
+            RemapFabArray<FArrayBox>(rho_cp[lev], dm, false);
+            RemapFabArray<IArrayBox>(rho_cp_owner_masks[lev], dm, true);
         }
 
+        // Copy of the coarse aux, buffers, and buffer masks
         if (lev > 0 && (n_field_gather_buffer > 0 || n_current_deposition_buffer > 0)) {
             for (int idim=0; idim < 3; ++idim)
             {
-                if (Bfield_cax[lev][idim])
-                {
-                    const IntVect& ng = Bfield_cax[lev][idim]->nGrowVect();
-                    auto pmf = std::unique_ptr<MultiFab>(new MultiFab(Bfield_cax[lev][idim]->boxArray(),
-                                                                      dm, 1, ng));
-                    // pmf->ParallelCopy(*Bfield_cax[lev][idim], 0, 0, 1, ng, ng);
-                    Bfield_cax[lev][idim] = std::move(pmf);
-                }
-                if (Efield_cax[lev][idim])
-                {
-                    const IntVect& ng = Efield_cax[lev][idim]->nGrowVect();
-                    auto pmf = std::unique_ptr<MultiFab>(new MultiFab(Efield_cax[lev][idim]->boxArray(),
-                                                                      dm, 1, ng));
-                    // pmf->ParallelCopy(*Efield_cax[lev][idim], 0, 0, 1, ng, ng);
-                    Efield_cax[lev][idim] = std::move(pmf);
-                }
-                if (current_buf[lev][idim])
-                {
-                    const IntVect& ng = current_buf[lev][idim]->nGrowVect();
-                    auto pmf = std::unique_ptr<MultiFab>(new MultiFab(current_buf[lev][idim]->boxArray(),
-                                                                      dm, 1, ng));
-                    // pmf->ParallelCopy(*current_buf[lev][idim], 0, 0, 1, ng, ng);
-                    current_buf[lev][idim] = std::move(pmf);
-                }
-            }
-            if (charge_buf[lev])
-            {
-                const IntVect& ng = charge_buf[lev]->nGrowVect();
-                auto pmf = std::unique_ptr<MultiFab>(new MultiFab(charge_buf[lev]->boxArray(),
-                                                                  dm, 1, ng));
-                // pmf->ParallelCopy(*charge_buf[lev][idim], 0, 0, 1, ng, ng);
-                charge_buf[lev] = std::move(pmf);
-            }
-            if (current_buffer_masks[lev])
-            {
-                const IntVect& ng = current_buffer_masks[lev]->nGrowVect();
-                auto pmf = std::unique_ptr<iMultiFab>(new iMultiFab(current_buffer_masks[lev]->boxArray(),
-                                                                    dm, 1, ng));
-                // pmf->ParallelCopy(*current_buffer_masks[lev], 0, 0, 1, ng, ng);
-                current_buffer_masks[lev] = std::move(pmf);                
-            }
-            if (gather_buffer_masks[lev])
-            {
-                const IntVect& ng = gather_buffer_masks[lev]->nGrowVect();
-                auto pmf = std::unique_ptr<iMultiFab>(new iMultiFab(gather_buffer_masks[lev]->boxArray(),
-                                                                    dm, 1, ng));
-                // pmf->ParallelCopy(*gather_buffer_masks[lev], 0, 0, 1, ng, ng);
-                gather_buffer_masks[lev] = std::move(pmf);                
+                RemapFabArray<FArrayBox>(Bfield_cax[lev][idim], dm, false);
+                RemapFabArray<FArrayBox>(Efield_cax[lev][idim], dm, false);
+                RemapFabArray<FArrayBox>(current_buf[lev][idim], dm, false);
             }
+            RemapFabArray<FArrayBox>(charge_buf[lev], dm, false);
+            RemapFabArray<IArrayBox>(current_buffer_masks[lev], dm, true);
+            RemapFabArray<IArrayBox>(gather_buffer_masks[lev], dm, true);
         }
 
         if (costs[lev] != nullptr) {
-            costs[lev].reset(new MultiFab(costs[lev]->boxArray(), dm, 1, 0));
+            RemapFabArray<FArrayBox>(costs[lev], dm, false);
             costs[lev]->setVal(0.0);
         }
 
         SetDistributionMap(lev, dm);
+
+        if (do_pml && pml[lev] && pml[lev]->ok()) {
+            pml[lev]->ChangeDistributionMap(ba, dm);
+        }
     }
     else
     {
-        amrex::Abort("RemakeLevel: to be implemented");
+        // New grids, either from regridding (lev > 0) or from splitting the
+        // boxes when load balancing (see LoadBalance).
+        // As in MakeNewLevelFromCoarse, the patches start from zero, except
+        // where the new grids overlap with the old ones, which keep their data.
+        const bool same_region = ba.contains(boxArray(lev)) && boxArray(lev).contains(ba);
+
+        std::array<std::unique_ptr<MultiFab>,3> old_E_fp, old_B_fp, old_E_cp, old_B_cp;
+        for (int idim = 0; idim < 3; ++idim) {
+            old_E_fp[idim] = std::move(Efield_fp[lev][idim]);
+            old_B_fp[idim] = std::move(Bfield_fp[lev][idim]);
+            old_E_cp[idim] = std::move(Efield_cp[lev][idim]);
+            old_B_cp[idim] = std::move(Bfield_cp[lev][idim]);
+        }
+        std::unique_ptr<MultiFab> old_F_fp = std::move(F_fp[lev]);
+        std::unique_ptr<MultiFab> old_F_cp = std::move(F_cp[lev]);
+
+        AllocLevelData(lev, ba, dm);
+        InitLevelData(lev, time);
+
+        const auto& period = Geom(lev).periodicity();
+        const IntVect ng0 = IntVect::TheZeroVector();
+        for (int idim = 0; idim < 3; ++idim) {
+            Efield_fp[lev][idim]->ParallelCopy(*old_E_fp[idim], 0, 0, 1, ng0,
+                                               Efield_fp[lev][idim]->nGrowVect(), period);
+            Bfield_fp[lev][idim]->ParallelCopy(*old_B_fp[idim], 0, 0, 1, ng0,
+                                               Bfield_fp[lev][idim]->nGrowVect(), period);
+        }
+        if (old_F_fp) {
+            F_fp[lev]->ParallelCopy(*old_F_fp, 0, 0, 1, ng0, F_fp[lev]->nGrowVect(), period);
+        }
+        if (lev > 0)
+        {
+            const auto& cperiod = Geom(lev-1).periodicity();
+            for (int idim = 0; idim < 3; ++idim) {
+                Efield_cp[lev][idim]->ParallelCopy(*old_E_cp[idim], 0, 0, 1, ng0,
+                                                   Efield_cp[lev][idim]->nGrowVect(), cperiod);
+                Bfield_cp[lev][idim]->ParallelCopy(*old_B_cp[idim], 0, 0, 1, ng0,
+                                                   Bfield_cp[lev][idim]->nGrowVect(), cperiod);
+            }
+            if (old_F_cp) {
+                F_cp[lev]->ParallelCopy(*old_F_cp, 0, 0, 1, ng0, F_cp[lev]->nGrowVect(), cperiod);
+            }
+        }
+
+#ifdef WARPX_USE_PSATD
+        // The FFT grids only depend on the domain and on ngroups_fft (see
+        // FFTDomainDecomposition), and the data is copied to them at each
+        // step: they are kept as they are if they already exist.
+        if (Efield_fp_fft[lev][0] == nullptr) {
+            AllocLevelDataFFT(lev);
+            InitLevelDataFFT(lev, time);
+        }
+#endif
+
+        // The PML is rebuilt on the new grids. It only keeps its data if the
+        // level covers the same region (e.g. when the boxes have been split);
+        // otherwise the PML around the new patch starts from zero.
+        std::unique_ptr<PML> old_pml = std::move(pml[lev]);
+        InitPML(lev, ba, dm);
+        if (same_region && old_pml && pml[lev]) {
+            pml[lev]->CopyFrom(*old_pml);
+        }
     }
 }
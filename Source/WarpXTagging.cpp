@@ -1,34 +1,161 @@
 
 #include <WarpX.H>
-#include <AMReX_BoxIterator.H>
+#include <WarpX_f.H>
+#include <AMReX_MultiFabUtil.H>
 #include <array>
 #include <algorithm>
+#include <cmath>
 
 using namespace amrex;
 
+/* \brief Tag the cells of level `lev` that should be covered by level `lev+1`.
+ *
+ * A cell is tagged if any of the active criteria is met:
+ * - its center is inside the box [fine_tag_lo, fine_tag_hi]
+ * - the number density of particles (all species) exceeds tag_particle_density
+ * - |E| varies by more than tag_E_gradient across the cell
+ * - the user function tag_function(x,y,z,t) is positive
+ */
 void
 WarpX::ErrorEst (int lev, TagBoxArray& tags, Real time, int /*ngrow*/)
 {
     const Real* problo = Geometry::ProbLo();
     const Real* dx = Geom(lev).CellSize();
+    const int tagval = TagBox::SET;
 
+    if (tag_static_box)
+    {
+        // Cells whose center is strictly inside [fine_tag_lo, fine_tag_hi]
+        IntVect lo, hi;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            lo[idim] = static_cast<int>(std::floor((fine_tag_lo[idim]-problo[idim])/dx[idim] - 0.5)) + 1;
+            hi[idim] = static_cast<int>(std::ceil ((fine_tag_hi[idim]-problo[idim])/dx[idim] - 0.5)) - 1;
+        }
+        const Box tag_box(lo, hi);
+
+        if (tag_box.ok())
+        {
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-    for (MFIter mfi(tags); mfi.isValid(); ++mfi)
+            for (MFIter mfi(tags, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.tilebox() & tag_box;
+                if (bx.ok()) {
+                    tags[mfi].setVal(TagBox::SET, bx);
+                }
+            }
+        }
+    }
+
+    if (tag_particle_density > 0.0)
     {
-        auto& fab = tags[mfi];
-        const Box& bx = fab.box();
-        for (BoxIterator bi(bx); bi.ok(); ++bi)
+        std::unique_ptr<MultiFab> ndens = mypc->GetNumberDensity(lev);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
         {
-            const IntVect& cell = bi();
-            RealVect pos {AMREX_D_DECL((cell[0]+0.5)*dx[0]+problo[0],
-                                       (cell[1]+0.5)*dx[1]+problo[1],
-                                       (cell[2]+0.5)*dx[2]+problo[2])};
-            if (pos > fine_tag_lo && pos < fine_tag_hi) {
-                fab(cell) = TagBox::SET;
+            Vector<int> itags;
+            for (MFIter mfi(tags, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                const Box& tbx = mfi.tilebox();
+                TagBox& tagfab = tags[mfi];
+                tagfab.get_itags(itags, tbx);
+                warpx_tag_threshold(BL_TO_FORTRAN_BOX(tbx),
+                                    itags.dataPtr(), AMREX_ARLIM_3D(tbx.loVect()), AMREX_ARLIM_3D(tbx.hiVect()),
+                                    BL_TO_FORTRAN_ANYD((*ndens)[mfi]),
+                                    tag_particle_density, tagval);
+                tagfab.tags(itags, tbx);
             }
         }
     }
-}
 
+    if (tag_E_gradient > 0.0)
+    {
+        // Cell-centered E, with one ghost cell for the differences.  The ghost
+        // cells that do not overlap another grid of this level (e.g. at the
+        // coarse/fine boundary) are not filled and are never read.
+        MultiFab Ecc(boxArray(lev), DistributionMap(lev), 3, 1);
+        Ecc.setVal(0.0);
+        Vector<const MultiFab*> srcmf(AMREX_SPACEDIM);
+        PackPlotDataPtrs(srcmf, Efield_aux[lev]);
+        amrex::average_edge_to_cellcenter(Ecc, 0, srcmf);
+#if (AMREX_SPACEDIM == 2)
+        MultiFab::Copy(Ecc, Ecc, 1, 2, 1, 0);
+        amrex::average_node_to_cellcenter(Ecc, 1, *Efield_aux[lev][1], 0, 1);
+#endif
+        const Geometry& geom = Geom(lev);
+        Ecc.FillBoundary(geom.periodicity());
+
+        const BoxArray& ba = boxArray(lev);
+        const Box& domain = geom.Domain();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Vector<int> itags;
+            for (MFIter mfi(tags, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                // The differences are centered where the neighboring layer of
+                // cells is covered by this level (across periodic boundaries
+                // too), and one-sided otherwise
+                const Box& vbx = mfi.validbox();
+                Box clamp_box = vbx;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    for (int iside = 0; iside < 2; ++iside) {
+                        Box slab = (iside == 0) ? amrex::adjCellLo(vbx, idim, 1)
+                                                : amrex::adjCellHi(vbx, idim, 1);
+                        if (geom.isPeriodic(idim) && !domain.contains(slab)) {
+                            slab.shift(idim, (iside == 0) ? domain.length(idim) : -domain.length(idim));
+                        }
+                        if (domain.contains(slab) && ba.contains(slab)) {
+                            if (iside == 0) {
+                                clamp_box.growLo(idim, 1);
+                            } else {
+                                clamp_box.growHi(idim, 1);
+                            }
+                        }
+                    }
+                }
+
+                const Box& tbx = mfi.tilebox();
+                TagBox& tagfab = tags[mfi];
+                tagfab.get_itags(itags, tbx);
+                warpx_tag_efield_gradient(BL_TO_FORTRAN_BOX(tbx),
+                                          itags.dataPtr(), AMREX_ARLIM_3D(tbx.loVect()), AMREX_ARLIM_3D(tbx.hiVect()),
+                                          BL_TO_FORTRAN_ANYD(Ecc[mfi]),
+                                          BL_TO_FORTRAN_BOX(clamp_box),
+                                          tag_E_gradient, tagval);
+                tagfab.tags(itags, tbx);
+            }
+        }
+    }
+
+    if (tag_parser_instance_number >= 0)
+    {
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(tags, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            TagBox& fab = tags[mfi];
+            const Box& bx = mfi.tilebox();
+            for (IntVect cell = bx.smallEnd(); cell <= bx.bigEnd(); bx.next(cell))
+            {
+#if (AMREX_SPACEDIM == 3)
+                const std::array<Real,4> list_var {(cell[0]+0.5)*dx[0]+problo[0],
+                                                   (cell[1]+0.5)*dx[1]+problo[1],
+                                                   (cell[2]+0.5)*dx[2]+problo[2], time};
+#else
+                const std::array<Real,4> list_var {(cell[0]+0.5)*dx[0]+problo[0], 0.0,
+                                                   (cell[1]+0.5)*dx[1]+problo[1], time};
+#endif
+                if (parser_evaluate_function(list_var.data(), 4, tag_parser_instance_number) > 0.0) {
+                    fab(cell) = TagBox::SET;
+                }
+            }
+        }
+    }
+}
@@ -61,7 +61,9 @@ void ConvertLabParamsToBoost()
     BL_ASSERT(prob_hi.size() == AMREX_SPACEDIM);
 
     pp_amr.query("max_level", max_level);
-    if (max_level > 0){
+    // The static refinement box is optional when other tagging criteria are used
+    const bool has_fine_tag = (max_level > 0) && pp_wpx.contains("fine_tag_lo");
+    if (has_fine_tag){
       pp_wpx.getarr("fine_tag_lo", fine_tag_lo);
       pp_wpx.getarr("fine_tag_hi", fine_tag_hi);
     }
@@ -81,7 +83,7 @@ void ConvertLabParamsToBoost()
             convert_factor = 1./( gamma_boost * ( 1 - beta_boost ) );
             prob_lo[idim] *= convert_factor;
             prob_hi[idim] *= convert_factor;
-            if (max_level > 0){
+            if (has_fine_tag){
               fine_tag_lo[idim] *= convert_factor;
               fine_tag_hi[idim] *= convert_factor;
             }
@@ -90,8 +92,23 @@ void ConvertLabParamsToBoost()
     }
     pp_geom.addarr("prob_lo", prob_lo);
     pp_geom.addarr("prob_hi", prob_hi);
-    if (max_level > 0){
+    if (has_fine_tag){
       pp_wpx.addarr("fine_tag_lo", fine_tag_lo);
       pp_wpx.addarr("fine_tag_hi", fine_tag_hi);
     }
 }
+
+void SplitAmongRanks(long n, long& ibegin, long& iend)
+{
+    const int myproc = ParallelDescriptor::MyProc();
+    const int nprocs = ParallelDescriptor::NProcs();
+    const long navg = n/nprocs;
+    const long nleft = n - navg * nprocs;
+    if (myproc < nleft) {
+        ibegin = myproc*(navg+1);
+        iend = ibegin + navg+1;
+    } else {
+        ibegin = myproc*navg + nleft;
+        iend = ibegin + navg;
+    }
+}
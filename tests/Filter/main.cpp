@@ -0,0 +1,232 @@
+
+#include <random>
+#include <limits>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Vector.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_PlotFileUtil.H>
+
+#include <WarpX_f.H>
+#include <WarpXFilter.H>
+
+using namespace amrex;
+
+namespace
+{
+    // Full-stencil version of a 1D pass with central weight alpha applied
+    // along each direction: the weight of a neighbor is the product of the
+    // 1D weights of its offsets.
+    void CompensationFab (const Box& bx, const FArrayBox& src, FArrayBox& dst,
+                          int ncomp, Real alpha)
+    {
+        const Real w1d[3] = {0.5*(1.0-alpha), alpha, 0.5*(1.0-alpha)};
+        const Box stencil(IntVect(-1), IntVect(1));
+        for (int n = 0; n < ncomp; ++n) {
+            for (IntVect cell=bx.smallEnd(); cell <= bx.bigEnd(); bx.next(cell)) {
+                Real r = 0.0;
+                for (IntVect off=stencil.smallEnd(); off <= stencil.bigEnd(); stencil.next(off)) {
+                    Real w = 1.0;
+                    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                        w *= w1d[off[idim]+1];
+                    }
+                    r += w*src(cell+off,n);
+                }
+                dst(cell,n) = r;
+            }
+        }
+    }
+
+    // Reference result: npass applications of the full-stencil binomial
+    // filter (WRPX_FILTER), followed by the full-stencil compensation pass,
+    // on the whole fab (guard cells included), with zeros outside of it.
+    void ReferenceFilter (const MultiFab& src, MultiFab& dst, int npass, bool compensation)
+    {
+        const int ncomp = src.nComp();
+        const int width = npass + (compensation ? 1 : 0);
+        for (MFIter mfi(dst); mfi.isValid(); ++mfi)
+        {
+            const Box& fbx = src[mfi].box();
+            FArrayBox in(amrex::grow(fbx,width), ncomp);
+            in.setVal(0.0);
+            in.copy(src[mfi], fbx, 0, fbx, 0, ncomp);
+            FArrayBox out;
+            for (int ipass = 0; ipass < npass; ++ipass)
+            {
+                const Box& bx = amrex::grow(fbx,width-ipass-1);
+                out.resize(bx,ncomp);
+                WRPX_FILTER(BL_TO_FORTRAN_BOX(bx),
+                            BL_TO_FORTRAN_ANYD(in),
+                            BL_TO_FORTRAN_ANYD(out),
+                            ncomp);
+                in.resize(bx,ncomp);
+                in.copy(out, bx, 0, bx, 0, ncomp);
+            }
+            if (compensation)
+            {
+                out.resize(fbx,ncomp);
+                CompensationFab(fbx, in, out, ncomp, 0.5*npass+1.0);
+                in.resize(fbx,ncomp);
+                in.copy(out, fbx, 0, fbx, 0, ncomp);
+            }
+            dst[mfi].copy(in, fbx, 0, fbx, 0, ncomp);
+        }
+    }
+
+    Real MaxDiff (const MultiFab& a, const MultiFab& b, int ngrow)
+    {
+        const int ncomp = a.nComp();
+        MultiFab diff(a.boxArray(), a.DistributionMap(), ncomp, ngrow);
+        MultiFab::Copy(diff, a, 0, 0, ncomp, ngrow);
+        MultiFab::Subtract(diff, b, 0, 0, ncomp, ngrow);
+        Real maxdiff = 0.0;
+        for (int n = 0; n < ncomp; ++n) {
+            maxdiff = std::max(maxdiff, diff.norm0(n, ngrow));
+        }
+        return maxdiff;
+    }
+}
+
+// Check the filter used by WarpX (ApplyBinomialFilter and
+// ApplyBinomialFilterInPlace, applied as separable 1D passes) against the
+// full-stencil filter, for several numbers of passes, with and without the
+// compensation pass.  The in-place filter is checked on the guard cells too.
+// With filter.do_timing = 1, also time the full stencil against the
+// separable passes.
+int main(int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    {
+        Vector<int> n_cell(AMREX_SPACEDIM, 128);
+        int max_grid_size = 64;
+        int ncomp = 3;
+        int do_timing = 0;
+        int nrepeat = 5;
+        {
+            ParmParse pp("filter");
+            pp.queryarr("n_cell", n_cell, 0, AMREX_SPACEDIM);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("ncomp", ncomp);
+            pp.query("do_timing", do_timing);
+            pp.query("nrepeat", nrepeat);
+        }
+
+        const Vector<std::pair<int,bool> > cases {{1,false}, {2,false}, {4,false},
+                                                  {1,true}, {3,true}};
+        int ngrow = 0;
+        for (const auto& c : cases) {
+            ngrow = std::max(ngrow, c.first + (c.second ? 1 : 0));
+        }
+
+        Box domain{IntVect{AMREX_D_DECL(0,0,0)},
+                   IntVect{AMREX_D_DECL(n_cell[0]-1,n_cell[1]-1,n_cell[2]-1)}};
+        BoxArray grids{domain};
+        grids.maxSize(max_grid_size);
+        DistributionMapping dmap {grids};
+
+        MultiFab src(grids, dmap, ncomp, ngrow);
+        MultiFab dst_ref(grids, dmap, ncomp, ngrow);
+        MultiFab dst(grids, dmap, ncomp, 0);
+        MultiFab inplace(grids, dmap, ncomp, ngrow);
+
+        std::mt19937 rand_eng(42);
+        std::uniform_real_distribution<Real> rand_dis(0.0,1.0);
+        for (MFIter mfi(src); mfi.isValid(); ++mfi)
+        {
+            FArrayBox& fab = src[mfi];
+            const Box& bx = fab.box();
+            for (int n = 0; n < ncomp; ++n) {
+                for (IntVect cell=bx.smallEnd(); cell <= bx.bigEnd(); bx.next(cell)) {
+                    fab(cell,n) = rand_dis(rand_eng);
+                }
+            }
+        }
+
+        const Real tol = 100.0*std::numeric_limits<Real>::epsilon();
+        for (const auto& c : cases)
+        {
+            const int npass = c.first;
+            const bool compensation = c.second;
+
+            ReferenceFilter(src, dst_ref, npass, compensation);
+
+            ApplyBinomialFilter(dst, src, npass, compensation, 0, 0, ncomp);
+            const Real maxdiff = MaxDiff(dst, dst_ref, 0);
+
+            MultiFab::Copy(inplace, src, 0, 0, ncomp, ngrow);
+            ApplyBinomialFilterInPlace(inplace, npass, compensation, 0, ncomp);
+            const Real maxdiff_inplace = MaxDiff(inplace, dst_ref, ngrow);
+
+            amrex::Print() << "npass = " << npass << ", compensation = " << compensation
+                           << ": max difference " << maxdiff
+                           << " (in place: " << maxdiff_inplace << ")\n";
+
+            if (maxdiff > tol || maxdiff_inplace > tol) {
+                amrex::Abort("The separable filter does not match the full stencil filter");
+            }
+        }
+
+        // Optional benchmark: one pass of the full 27-point stencil against
+        // the same filter applied as separable 1D passes
+        if (do_timing)
+        {
+            Real t_full = amrex::second();
+            for (int irep = 0; irep < nrepeat; ++irep)
+            {
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+                for (MFIter mfi(dst,true); mfi.isValid(); ++mfi)
+                {
+                    const Box& tbx = mfi.tilebox();
+                    WRPX_FILTER(BL_TO_FORTRAN_BOX(tbx),
+                                BL_TO_FORTRAN_ANYD(src[mfi]),
+                                BL_TO_FORTRAN_ANYD(dst[mfi]),
+                                ncomp);
+                }
+            }
+            t_full = amrex::second() - t_full;
+
+            Real t_sep = amrex::second();
+            for (int irep = 0; irep < nrepeat; ++irep) {
+                ApplyBinomialFilter(dst, src, 1, false, 0, 0, ncomp);
+            }
+            t_sep = amrex::second() - t_sep;
+
+            Real t_inplace = amrex::second();
+            for (int irep = 0; irep < nrepeat; ++irep) {
+                ApplyBinomialFilterInPlace(inplace, 1, false, 0, ncomp);
+            }
+            t_inplace = amrex::second() - t_inplace;
+
+            ParallelDescriptor::ReduceRealMax(t_full);
+            ParallelDescriptor::ReduceRealMax(t_sep);
+            ParallelDescriptor::ReduceRealMax(t_inplace);
+
+            amrex::Print() << "Full stencil filter:         " << t_full    << " s\n"
+                           << "Separable filter:            " << t_sep     << " s"
+                           << " (speedup " << t_full/t_sep << ")\n"
+                           << "Separable filter, in place:  " << t_inplace << " s"
+                           << " (speedup " << t_full/t_inplace << ")\n";
+
+            // Leave the result of the last case in dst for the plotfile
+            ApplyBinomialFilter(dst, src, cases.back().first, cases.back().second, 0, 0, ncomp);
+        }
+
+        Real dx[3] = {1.0/n_cell[0], 1.0/n_cell[1], 1.0/n_cell[AMREX_SPACEDIM-1]};
+        Real xyzmin[3] = {0.0,0.0,0.0};
+        RealBox realbox{domain, dx, xyzmin};
+        int is_per[3] = {0,0,0};
+        Geometry geom{domain, &realbox, 0, is_per};
+        std::string plotname{"plotfiles/plt00000"};
+        Vector<std::string> varnames;
+        for (int n = 0; n < ncomp; ++n) {
+            varnames.push_back("f"+std::to_string(n));
+        }
+        amrex::WriteSingleLevelPlotfile(plotname, dst, varnames, geom, 0.0, 0);
+    }
+
+    amrex::Finalize();
+}